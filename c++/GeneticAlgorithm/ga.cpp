@@ -2,6 +2,7 @@
 #include "Random/Uniform.hpp"
 #include "Random/Normal.hpp"
 #include "mapreduce.hpp"
+#include "parallel.hpp"
 
 #include <vector>
 #include <functional>
@@ -12,15 +13,24 @@
 #include <iostream>
 #include <stdexcept>
 #include <iterator>
+#include <string>
+#include <cstdint>
 
+#include "precision.hpp"
 
-typedef double Real;
 
+template <typename Real>
 bool isClose(Real value, Real target, Real flex)
 {
     return (1 - flex) * target <= value && value <= (1 + flex) * target;
 }
 
+template <typename Real>
+Real clamp(Real value, Real min, Real max)
+{
+    return value < min ? min : (max < value ? max : value);
+}
+
 struct Settings {
     Settings(unsigned int size, unsigned int K, unsigned int M, unsigned int N, unsigned int CO)
         : size(size)
@@ -55,13 +65,27 @@ struct Settings {
     }
 };
 
-template <typename E>
+/*!
+ * Genetic algorithm on a population of entities of type E
+ *
+ * The new entities of a generation, and their fitness, are computed by
+ * several threads : the mutations and the replacements are each split into
+ * chunkCount chunks, and every chunk draws from its own random stream,
+ * derived from the seed and kept for the whole run. The result of a run
+ * therefore only depends on the seed, not on the number of threads.
+ *
+ * The generator, the evaluator, the crossover and the mutator are called
+ * concurrently and must be thread-safe; the generator and the mutator draw
+ * their random numbers from RandomContext::current(), which is bound to the
+ * stream of the chunk being computed. E must be default constructible.
+ */
+template <typename E, typename Real>
 class Population
 {
 public:
     // Type Aliases
 
-    typedef std::tuple<E, double> EntityFitness;
+    typedef std::tuple<E, Real> EntityFitness;
     typedef std::vector<EntityFitness> Pop;
 
     typedef typename std::function<E()> Generator;
@@ -71,6 +95,9 @@ public:
 
     typedef typename std::function<bool(Pop const&)> Terminator;
 
+    /// Number of chunks, and of random streams, of each step; the most threads that are useful
+    static constexpr std::size_t chunkCount = 64;
+
 public:
     // Public API
 
@@ -85,30 +112,50 @@ public:
      * @param crossover Takes two entities to produce a new one
      * @param mutator Mutate an entity
      * @param terminator Determine if the population has converged or not
+     * @param random Source of randomness; every run draws its seed from it
+     * @param threads number of threads computing the generations
      */
-    Population(Settings settings, Generator generator, Evaluator evaluator, CrossOver crossover, Mutator mutator, Terminator terminator)
+    Population(Settings settings, Generator generator, Evaluator evaluator, CrossOver crossover, Mutator mutator, Terminator terminator, RandomContext random, std::size_t threads = 1)
         : settings(settings)
         , generator(generator)
         , evaluator(evaluator)
         , crossover(crossover)
         , mutator(mutator)
-        , terminator(terminator) {
+        , terminator(terminator)
+        , random(random)
+        , threads(threads) {
+    }
+
+    std::size_t threadCount() const {
+        return threads;
     }
 
     /// Apply the genetic algorithm until the population stabilise and return the best entity
     E run() {
+        // The threads are started once for the whole run
+        ThreadPool pool(threads);
+
+        // Every step gets its own streams
+        const RandomContext run(random.engine()());
+        enum Step { INITIALISATION, MUTATION, REPLACEMENT };
 
         const auto entityWithFitness = [&](E const& entity) -> EntityFitness {
             return EntityFitness(entity, evaluator(entity));
         };
 
+        // Index of a random entity from the living ones, that is in range [0, size-K[
+        const auto living = [&](RandomContext& context) -> unsigned int {
+            return uniform<unsigned int>(context, 0, settings.size - settings.K - 1);
+        };
+
         // Step 1 + 2.
         // -----------
         //
         // Generate a population & evaluate it
-        Pop pop; // collection of (entitiy, fitness)
-        std::generate_n(std::back_inserter(pop), settings.size, [&]() {
-            return entityWithFitness(generator());
+        Pop pop(settings.size); // collection of (entitiy, fitness)
+        std::vector<RandomContext> initialisationStreams = streams(run, INITIALISATION);
+        forEachChunk(pool, initialisationStreams, settings.size, [&](std::size_t i, RandomContext&) {
+            pop[i] = entityWithFitness(generator());
         });
         // Now sort it
         const auto comparator = [](EntityFitness const& a, EntityFitness const& b) -> bool {
@@ -116,6 +163,19 @@ public:
         };
         std::sort(pop.begin(), pop.end(), comparator);
 
+        // Mutated entities and their index in the population
+        std::vector<unsigned int> mutatedIndexes(settings.M);
+        Pop mutated(settings.M);
+
+        // Buffers used to keep the population sorted, see step 7
+        std::vector<bool> changed(settings.size, false);
+        Pop changedEntities;
+        changedEntities.reserve(settings.M);
+        Pop next(settings.size);
+
+        std::vector<RandomContext> mutationStreams = streams(run, MUTATION);
+        std::vector<RandomContext> replacementStreams = streams(run, REPLACEMENT);
+
         // unsigned int rounds = 0;
 
         do {
@@ -134,42 +194,39 @@ public:
             //
             // Mutate M individuals of the population
 
-            // Choose M random individuals from the living ones, that is in range [0, size-K[
-            for (unsigned int count = 0; count < settings.M; ++count) {
-                const unsigned int rangeStart = 0;
-                const unsigned int rangeEnd = settings.size - settings.K - 1;
-                const unsigned int index = uniform<unsigned int>(rangeStart, rangeEnd);
+            // Choose M random individuals from the living ones; the mutations
+            // are computed from the current population and then stored in
+            // order, so that an individual chosen twice keeps its last mutation
+            forEachChunk(pool, mutationStreams, settings.M, [&](std::size_t count, RandomContext& context) {
+                const unsigned int index = living(context);
 
-                pop[index] = entityWithFitness(mutator(std::get<0>(pop[index])));
+                mutatedIndexes[count] = index;
+                mutated[count] = entityWithFitness(mutator(std::get<0>(pop[index])));
+            });
+            for (unsigned int count = 0; count < settings.M; ++count) {
+                pop[mutatedIndexes[count]] = mutated[count];
             }
 
 
-            // Step 5.
-            // -------
+            // Step 5 + 6.
+            // -----------
             //
-            // Create CO new individuals with CrossOver
-
-            // Replace the last CO entities before the N last ones (see comment at step 3)
-            for (unsigned int i = settings.size - settings.N - 1, count = 0; count < settings.CO; ++count, --i) {
-                // Select two random entities from the living ones, that is in range [0, size-K[
-                const unsigned int rangeStart = 0;
-                const unsigned int rangeEnd = settings.size - settings.K - 1;
-                const unsigned int first = uniform<unsigned int>(rangeStart, rangeEnd);
-                const unsigned int second = uniform<unsigned int>(rangeStart, rangeEnd);
-
-                pop[i] = entityWithFitness(crossover(std::get<0>(pop[first]), std::get<0>(pop[second])));
-            }
+            // Create CO new individuals with CrossOver and N new individuals randomly
 
+            // Replace the last N entities with random ones and the CO entities
+            // before them with crossovers (see comment at step 3); only living
+            // entities are read, so they can all be computed concurrently
+            forEachChunk(pool, replacementStreams, settings.K, [&](std::size_t count, RandomContext& context) {
+                if (count < settings.CO) {
+                    // Select two random entities from the living ones
+                    const unsigned int first = living(context);
+                    const unsigned int second = living(context);
 
-            // Step 6.
-            // -------
-            //
-            // Generate N new individuals randomly
-
-            // Replace the last N entities (see comment at step 3)
-            for (unsigned int i = settings.size - 1, count = 0; count < settings.N; ++count, --i) {
-                pop[i] = entityWithFitness(generator());
-            }
+                    pop[settings.size - settings.N - 1 - count] = entityWithFitness(crossover(std::get<0>(pop[first]), std::get<0>(pop[second])));
+                } else {
+                    pop[settings.size - 1 - (count - settings.CO)] = entityWithFitness(generator());
+                }
+            });
 
 
             // Step 7.
@@ -178,8 +235,38 @@ public:
             // Evaluate the current population
 
             // The evaluation of new entities was already done in step 3 to 6
-            // So we only sort the population
-            std::sort(pop.begin(), pop.end(), comparator);
+            // So we only sort the population again
+            //
+            // Only the M + K entities changed by steps 4 to 6 are out of
+            // place : the others are moved, in order, to the front, the
+            // changed ones are sorted behind them and the two sorted ranges
+            // are merged. This costs O(size + (M + K) log(M + K)) instead of
+            // O(size log size) for a full sort.
+            for (auto const& index: mutatedIndexes) {
+                changed[index] = true;
+            }
+
+            const unsigned int survivors = settings.size - settings.K;
+            unsigned int kept = 0;
+            for (unsigned int i = 0; i < survivors; ++i) {
+                if (changed[i]) {
+                    changed[i] = false;
+                    changedEntities.push_back(std::move(pop[i]));
+                } else {
+                    if (kept != i) {
+                        pop[kept] = std::move(pop[i]);
+                    }
+                    ++kept;
+                }
+            }
+            std::move(changedEntities.begin(), changedEntities.end(), pop.begin() + kept);
+            changedEntities.clear();
+
+            std::sort(pop.begin() + kept, pop.end(), comparator);
+            std::merge(std::make_move_iterator(pop.begin()), std::make_move_iterator(pop.begin() + kept),
+                       std::make_move_iterator(pop.begin() + kept), std::make_move_iterator(pop.end()),
+                       next.begin(), comparator);
+            pop.swap(next);
 
 
             // Step 8.
@@ -200,6 +287,38 @@ public:
         return std::get<0>(pop.front()); // the population is already sorted
     }
 
+private:
+    /// Streams of the chunks of a step, derived from the stream of the run
+    static std::vector<RandomContext> streams(RandomContext const& run, std::uint64_t step) {
+        std::vector<RandomContext> result;
+        result.reserve(chunkCount);
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            result.push_back(run.split(step * chunkCount + chunk));
+        }
+        return result;
+    }
+
+    /*!
+     * Call task(i, context) for every i in [0, count[ using the threads of the pool
+     *
+     * The indexes are split into one chunk per stream; a chunk draws from
+     * its stream, which is also bound to the thread while it runs.
+     */
+    template <typename Task>
+    static void forEachChunk(ThreadPool& pool, std::vector<RandomContext>& streams, std::size_t count, Task const& task) {
+        const std::size_t chunks = streams.size();
+
+        pool.run(chunks, [&](std::size_t chunk) {
+            RandomContext& context = streams[chunk];
+            RandomContext::Scope scope(context);
+
+            const std::size_t last = (chunk + 1) * count / chunks;
+            for (std::size_t i = chunk * count / chunks; i < last; ++i) {
+                task(i, context);
+            }
+        });
+    }
+
 private:
     // Data
     Settings settings;
@@ -208,15 +327,17 @@ private:
     CrossOver crossover;
     Mutator mutator;
     Terminator terminator;
+    RandomContext random;
+    std::size_t threads;
 };
 
-
-typedef std::tuple<Real, Real> Params;
+template <typename E, typename Real>
+constexpr std::size_t Population<E, Real>::chunkCount;
 
 
-template <typename E>
+template <typename E, typename Real>
 struct Action {
-    Action(Population<E>& popref)
+    Action(Population<E, Real>& popref)
         : popref(popref) {
     }
 
@@ -225,13 +346,14 @@ struct Action {
     }
 
     std::string csvdescription() const {
-        return "ø"; // no explicit parameters for the computation
+        return Precision<Real>::name() + "," + std::to_string(popref.threadCount());
     }
 
-    Population<E>& popref;
+    Population<E, Real>& popref;
 };
 
-std::ostream& operator<<(std::ostream& out, Params const& ps)
+template <typename Real>
+std::ostream& operator<<(std::ostream& out, std::tuple<Real, Real> const& ps)
 {
     Real x, y;
     std::tie(x, y) = ps;
@@ -241,9 +363,11 @@ std::ostream& operator<<(std::ostream& out, Params const& ps)
 
 #include "stats.hpp"
 
-int main(int, char const**)
+template <typename Real>
+void benchmark(std::size_t threads)
 {
-    using Population = Population<Params>;
+    typedef std::tuple<Real, Real> Params;
+    typedef ::Population<Params, Real> Population;
 
     // Equation :
     //
@@ -276,12 +400,23 @@ int main(int, char const**)
     };
 
     // Mutator; takes a normal distribution to shift the current value
+    //
+    // The shifts have a standard deviation of 0.1% of the range and are drawn
+    // from the normal variates buffered by the current random context.
     const auto mutator = [](Params const& ps) -> Params {
-        return ps; // TODO implement me !
+        constexpr Real SIGMA_X = (MAX_X - MIN_X) / 1000, SIGMA_Y = (MAX_Y - MIN_Y) / 1000;
+
+        Real x, y;
+        std::tie(x, y) = ps;
+
+        x += SIGMA_X * RandomContext::current().nextNormal<Real>();
+        y += SIGMA_Y * RandomContext::current().nextNormal<Real>();
+
+        return Params(clamp(x, MIN_X, MAX_X), clamp(y, MIN_Y, MAX_Y));
     };
 
     // Terminator; stop evolution when population has (relatively) converged
-    const auto terminator = [&](Population::Pop const& pop) -> bool {
+    const auto terminator = [&](typename Population::Pop const& pop) -> bool {
         // Compute average on x and y axes
         Real avgX(0), avgY(0);
         for (auto const& ef: pop) {
@@ -298,7 +433,7 @@ int main(int, char const**)
 
         // Stop when 75% of the population is in the range [(1 - ε) * µ, (1 + ε) * µ]
         unsigned int maxOuts = pop.size() * 0.25;
-        constexpr Real EPSILON = 0.02;
+        constexpr Real EPSILON = Real(0.02);
 
         unsigned int outs = 0;
         for (auto const& ef: pop) {
@@ -318,12 +453,28 @@ int main(int, char const**)
     // Settings
     const Settings settings(1000, 100, 50, 50, 50);
 
-    // Create the population
-    Population pop(settings, generator, evaluator, crossover, mutator, terminator);
+    // Create the population; the seed is fixed so that runs can be compared
+    Population pop(settings, generator, evaluator, crossover, mutator, terminator, RandomContext(20130101), threads);
 
 
     // Run the Genetic Algorithm
-    stats<Action<Params>, Params>(Action<Params>(pop), 100);
+    stats<Action<Params, Real>, Params>(Action<Params, Real>(pop), 100);
+}
+
+int main(int, char const**)
+{
+    // The output is precision,threads,x,y,time; the best entities do not
+    // depend on the number of threads
+    std::vector<std::size_t> threadCounts = { 1 };
+    if (hardwareThreads() > 1) {
+        threadCounts.push_back(hardwareThreads());
+    }
+
+    for (auto const& threads: threadCounts) {
+        benchmark<float>(threads);
+        benchmark<double>(threads);
+        benchmark<long double>(threads);
+    }
 
     return 0;
 }
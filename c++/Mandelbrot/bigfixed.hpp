@@ -0,0 +1,204 @@
+
+#ifndef MANDELBROT_BIGFIXED_HPP
+#define MANDELBROT_BIGFIXED_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+//
+// Multi-precision fixed-point number, used to compute reference orbits for
+// deep zooms where double precision is not enough.
+//
+// The magnitude is stored in 32-bit limbs, least significant first : the last
+// limb holds the integer part and the others the fraction. The number of limbs
+// is chosen at construction and fixes the precision; operations between two
+// numbers require the same number of limbs. Results are truncated.
+//
+// The integer part is small (|z| < 2 before escaping for the Mandelbrot set)
+// so no overflow check is done on it.
+//
+class BigFixed
+{
+public:
+    typedef std::uint32_t Limb;
+    static constexpr std::size_t limbBits = 32;
+
+    // Number of limbs needed for `fractionBits` bits after the binary point
+    static std::size_t limbsFor(std::size_t fractionBits)
+    {
+        return 1 + (fractionBits + limbBits - 1) / limbBits;
+    }
+
+    // Zero
+    explicit BigFixed(std::size_t limbCount)
+    : negative(false)
+    , limbs(limbCount, 0)
+    { /* - */ }
+
+    // Exact conversion of a double, up to the precision
+    static BigFixed fromDouble(double value, std::size_t limbCount)
+    {
+        BigFixed result(limbCount);
+        result.negative = value < 0;
+
+        double rest = std::fabs(value);
+        for (std::size_t i = limbCount; i-- > 0;) {
+            const double limb = std::floor(rest);
+            result.limbs[i] = static_cast<Limb>(limb);
+            rest = (rest - limb) * 4294967296.0; // 2^32
+        }
+
+        return result;
+    }
+
+    // Parse a decimal number such as "-0.7436438870371587047521915"
+    static BigFixed parse(std::string const& text, std::size_t limbCount)
+    {
+        BigFixed result(limbCount);
+
+        std::size_t pos = 0;
+        if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+            result.negative = text[pos] == '-';
+            ++pos;
+        }
+
+        Limb integer = 0;
+        for (; pos < text.size() && text[pos] != '.'; ++pos) {
+            integer = integer * 10 + digit(text[pos]);
+        }
+
+        // The fraction is accumulated from its last digit : f = (f + d) / 10
+        if (pos < text.size()) {
+            for (std::size_t i = text.size(); i-- > pos + 1;) {
+                result.limbs.back() += digit(text[i]);
+                result.divide(10);
+            }
+        }
+        result.limbs.back() = integer;
+
+        return result;
+    }
+
+    double toDouble() const
+    {
+        double value = 0;
+        for (std::size_t i = 0; i < limbs.size(); ++i) {
+            value = value / 4294967296.0 + limbs[i];
+        }
+        return negative ? -value : value;
+    }
+
+    BigFixed operator-() const
+    {
+        BigFixed result = *this;
+        result.negative = !negative;
+        return result;
+    }
+
+    BigFixed operator+(BigFixed const& other) const
+    {
+        if (negative == other.negative) {
+            BigFixed result = *this;
+            result.addMagnitude(other);
+            return result;
+        }
+
+        // Different signs : subtract the smaller magnitude from the bigger one
+        BigFixed result = compareMagnitude(other) >= 0 ? *this : other;
+        result.subtractMagnitude(compareMagnitude(other) >= 0 ? other : *this);
+        return result;
+    }
+
+    BigFixed operator-(BigFixed const& other) const
+    {
+        return *this + (-other);
+    }
+
+    BigFixed operator*(BigFixed const& other) const
+    {
+        const std::size_t n = limbs.size();
+
+        // Integer product of the magnitudes, then drop the n - 1 extra fraction limbs
+        std::vector<Limb> product(2 * n, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t carry = 0;
+            for (std::size_t j = 0; j < n; ++j) {
+                const std::uint64_t t = std::uint64_t(limbs[i]) * other.limbs[j] + product[i + j] + carry;
+                product[i + j] = static_cast<Limb>(t);
+                carry = t >> limbBits;
+            }
+            product[i + n] = static_cast<Limb>(carry);
+        }
+
+        BigFixed result(n);
+        result.negative = negative != other.negative;
+        for (std::size_t i = 0; i < n; ++i) {
+            result.limbs[i] = product[i + n - 1];
+        }
+        return result;
+    }
+
+private:
+    static Limb digit(char c)
+    {
+        if (c < '0' || c > '9') {
+            throw std::invalid_argument("Invalid digit in a decimal number");
+        }
+        return c - '0';
+    }
+
+    // Sign-less comparison : -1, 0 or 1
+    int compareMagnitude(BigFixed const& other) const
+    {
+        for (std::size_t i = limbs.size(); i-- > 0;) {
+            if (limbs[i] != other.limbs[i]) {
+                return limbs[i] < other.limbs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    void addMagnitude(BigFixed const& other)
+    {
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < limbs.size(); ++i) {
+            const std::uint64_t t = std::uint64_t(limbs[i]) + other.limbs[i] + carry;
+            limbs[i] = static_cast<Limb>(t);
+            carry = t >> limbBits;
+        }
+    }
+
+    // Requires |this| >= |other|
+    void subtractMagnitude(BigFixed const& other)
+    {
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < limbs.size(); ++i) {
+            std::int64_t t = std::int64_t(limbs[i]) - other.limbs[i] - borrow;
+            borrow = t < 0;
+            if (borrow) {
+                t += std::int64_t(1) << limbBits;
+            }
+            limbs[i] = static_cast<Limb>(t);
+        }
+    }
+
+    // Divide the magnitude by a small integer
+    void divide(Limb divisor)
+    {
+        std::uint64_t remainder = 0;
+        for (std::size_t i = limbs.size(); i-- > 0;) {
+            const std::uint64_t t = (remainder << limbBits) | limbs[i];
+            limbs[i] = static_cast<Limb>(t / divisor);
+            remainder = t % divisor;
+        }
+    }
+
+    bool negative;
+    std::vector<Limb> limbs;
+};
+
+#endif // MANDELBROT_BIGFIXED_HPP
@@ -4,7 +4,22 @@
 #include <complex>
 #include <cmath>
 #include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <bitset>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <limits>
+#include <map>
+#include <list>
+#include <tuple>
 #include "stats.hpp"
+#include "parallel.hpp"
+#include "precision.hpp"
+#include "simd.hpp"
+#include "bigfixed.hpp"
 
 #ifdef SAVE_IMAGE
     #include <SFML/Graphics.hpp>
@@ -18,51 +33,277 @@ enum class Color : bool {
 constexpr Color inSetColor = Color::WHITE;
 constexpr Color notInSetColor = Color::BLACK;
 
-typedef double Real;
+template <typename Real>
+using ComplexRange = std::pair<std::complex<Real>, std::complex<Real> >;
 
-typedef std::complex<Real> Complex;
+template <typename Real>
+std::ostream& operator<<(std::ostream& out, ComplexRange<Real> const& range)
+{
+    return out << "{"
+               << "(" << range.first.real() << ";" << range.first.imag() << ");"
+               << "(" << range.second.real() << ";" << range.second.imag() << ")"
+               << "}";
+}
 
-std::ostream& operator<<(std::ostream& out, Complex const& z)
+// Convert a range to another precision
+template <typename Real, typename Other>
+ComplexRange<Real> convertRange(ComplexRange<Other> const& range)
 {
-    return out << "(" << z.real() << ";" << z.imag() << ")";
+    return {
+        std::complex<Real>(range.first.real(), range.first.imag()),
+        std::complex<Real>(range.second.real(), range.second.imag())
+    };
 }
 
-typedef std::pair<Complex, Complex> ComplexRange;
+// Black and white image stored with one bit per pixel
+//
+// An image holds `height` consecutive rows, starting at `firstRow`, of a square
+// picture : the whole picture when rendered in memory or one horizontal band of
+// it when streamed to disk. Pixels are addressed with the picture coordinates.
+//
+// Each row starts on a new 64-bit word so that threads working on tiles whose
+// width is a multiple of 64 pixels never write to the same word. Pixel x of a
+// row is bit x % 64 of word x / 64; the unused bits of the last word are zero.
+class Image
+{
+public:
+    typedef std::uint64_t Word;
+    static constexpr std::size_t wordBits = 64;
+
+    // The whole side x side picture
+    explicit Image(std::size_t side)
+    : Image(side, side, 0)
+    { /* - */ }
+
+    // Rows [firstRow, firstRow + height[ of a side x side picture
+    Image(std::size_t side, std::size_t height, std::size_t firstRow)
+    : side_(side)
+    , height_(height)
+    , firstRow_(firstRow)
+    , wordsPerRow_((side + wordBits - 1) / wordBits)
+    , words_(wordsPerRow_ * height, 0)
+    { /* - */ }
+
+    std::size_t side() const { return side_; }
+
+    std::size_t height() const { return height_; }
+
+    std::size_t firstRow() const { return firstRow_; }
+
+    std::size_t endRow() const { return firstRow_ + height_; }
+
+    std::size_t size() const { return side_ * height_; }
+
+    std::size_t wordsPerRow() const { return wordsPerRow_; }
 
-std::ostream& operator<<(std::ostream& out, ComplexRange const& range)
+    // Memory needed to hold one row
+    static std::size_t rowBytes(std::size_t side)
+    {
+        return (side + wordBits - 1) / wordBits * sizeof(Word);
+    }
+
+    Color getPixel(std::size_t x, std::size_t y) const
+    {
+        return static_cast<Color>((getWord(x / wordBits, y) >> (x % wordBits)) & 1);
+    }
+
+    void setPixel(std::size_t x, std::size_t y, Color color)
+    {
+        Word& word = words_[(y - firstRow_) * wordsPerRow_ + x / wordBits];
+        const Word bit = Word(1) << (x % wordBits);
+        word = color == Color::WHITE ? (word | bit) : (word & ~bit);
+    }
+
+    // Word holding pixels [64 * i, 64 * i + 64[ of row y
+    Word getWord(std::size_t i, std::size_t y) const
+    {
+        return words_[(y - firstRow_) * wordsPerRow_ + i];
+    }
+
+    void setWord(std::size_t i, std::size_t y, Word word)
+    {
+        words_[(y - firstRow_) * wordsPerRow_ + i] = word;
+    }
+
+    // Number of pixels that differ between two images of the same size
+    std::size_t countDifferences(Image const& other) const
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            count += std::bitset<wordBits>(words_[i] ^ other.words_[i]).count();
+        }
+        return count;
+    }
+
+private:
+    std::size_t side_, height_, firstRow_, wordsPerRow_;
+    std::vector<Word> words_;
+};
+
+// Image storing one value per pixel, with the same rows layout as Image
+template <typename T>
+class ValueImage
 {
-    return out << "{" << range.first << ";" << range.second << "}";
-}
+public:
+    typedef T Value;
+
+    // Rows [firstRow, firstRow + height[ of a side x side picture
+    ValueImage(std::size_t side, std::size_t height, std::size_t firstRow = 0)
+    : side_(side)
+    , height_(height)
+    , firstRow_(firstRow)
+    , values_(side * height)
+    { /* - */ }
+
+    std::size_t side() const { return side_; }
+
+    std::size_t height() const { return height_; }
+
+    std::size_t firstRow() const { return firstRow_; }
+
+    std::size_t endRow() const { return firstRow_ + height_; }
+
+    T& pixel(std::size_t x, std::size_t y) { return values_[(y - firstRow_) * side_ + x]; }
+
+    T const& pixel(std::size_t x, std::size_t y) const { return values_[(y - firstRow_) * side_ + x]; }
+
+private:
+    std::size_t side_, height_, firstRow_;
+    std::vector<T> values_;
+};
+
+//
+// Output of computeElement, chosen at compile time so that the binary mode
+// does not pay for what the other modes need.
+//
+// value(iter, maxIterations, zr, zi) turns the number of iterations done before
+// escaping (maxIterations for points in the set) and the last value of the
+// orbit into the value of a pixel.
+//
+
+// In or out of the set
+struct BinaryOutput
+{
+    typedef Color Value;
+
+    static std::string name() { return "binary"; }
+
+    template <typename Real>
+    static Value value(std::size_t iter, std::size_t maxIterations, Real, Real)
+    {
+        return iter == maxIterations ? inSetColor : notInSetColor;
+    }
+};
 
-typedef std::vector<Color> Image; // square image stored in a 1D array
+// Number of iterations before escaping, saturated to the largest Count
+template <typename Count>
+struct CountOutput
+{
+    typedef Count Value;
+
+    static std::string name() { return "count" + std::to_string(8 * sizeof(Count)); }
+
+    template <typename Real>
+    static Value value(std::size_t iter, std::size_t, Real, Real)
+    {
+        return static_cast<Count>(std::min<std::size_t>(iter, std::numeric_limits<Count>::max()));
+    }
+};
+
+// Continuous (normalised) iteration count, for smooth gradients
+struct SmoothOutput
+{
+    typedef float Value;
+
+    static std::string name() { return "smooth"; }
+
+    template <typename Real>
+    static Value value(std::size_t iter, std::size_t maxIterations, Real zr, Real zi)
+    {
+        if (iter == maxIterations) {
+            return maxIterations;
+        }
+
+        // n + 1 - log2(log|z|), with log|z| = log(|z|²) / 2
+        return iter + 1 - std::log2(std::log(zr * zr + zi * zi) / 2);
+    }
+};
 
-std::size_t getSideSize(Image const& img)
+// Save iteration counts as a 16-bit PGM file; counts above 65535 are scaled down
+template <typename Count>
+void writePGM(std::string const& path, ValueImage<Count> const& img, std::size_t maxIterations)
 {
-    return std::sqrt(img.size());
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    const std::size_t maxValue = std::min<std::size_t>(maxIterations, 65535);
+    out << "P5\n" << img.side() << " " << img.height() << "\n" << std::max<std::size_t>(maxValue, 1) << "\n";
+
+    // Samples are stored big-endian
+    std::vector<char> row(2 * img.side());
+    for (std::size_t y = img.firstRow(); y < img.endRow(); ++y) {
+        for (std::size_t x = 0; x < img.side(); ++x) {
+            const std::size_t count = img.pixel(x, y);
+            const std::size_t sample = maxIterations > maxValue ? count * maxValue / maxIterations : count;
+            row[2 * x] = static_cast<char>(sample >> 8);
+            row[2 * x + 1] = static_cast<char>(sample & 0xFF);
+        }
+        out.write(row.data(), row.size());
+    }
 }
 
-Color& getPixel(Image& img, std::size_t x, std::size_t y)
+// Save smooth iteration counts as a grayscale PFM file
+void writePFM(std::string const& path, ValueImage<float> const& img)
 {
-    return img[y * getSideSize(img) + x];
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    // A negative scale means little-endian samples, the native order of our machines;
+    // the rows are stored from the bottom to the top
+    out << "Pf\n" << img.side() << " " << img.height() << "\n-1.0\n";
+    for (std::size_t y = img.endRow(); y > img.firstRow(); --y) {
+        out.write(reinterpret_cast<char const*>(&img.pixel(0, y - 1)), img.side() * sizeof(float));
+    }
 }
 
+// Side of the square tiles handed out to the threads
+constexpr std::size_t tileSide = Image::wordBits;
+
+// How the pixels of a tile are computed
+enum class Renderer {
+    PIXELS,     // every pixel is iterated
+    RECTANGLES  // Mariani–Silver subdivision : only rectangle borders are iterated
+};
+
+// Rectangles smaller than that are not subdivided further
+constexpr std::size_t minRectangleSide = 4;
+
+template <typename Real>
 struct Mandelbrot
 {
-    Mandelbrot(std::size_t side, std::size_t maxIterations, ComplexRange range)
+    typedef std::complex<Real> Complex;
+
+    Mandelbrot(std::size_t side, std::size_t maxIterations, ComplexRange<Real> range,
+               std::size_t threads = 1, Isa isa = Isa::SCALAR, bool interiorChecks = false,
+               Renderer renderer = Renderer::PIXELS)
     : side(side)
     , maxIterations(maxIterations)
     , range(range)
+    , threads(threads)
+    , isa(isa)
+    , interiorChecks(interiorChecks)
+    , renderer(renderer)
     { /* - */ }
 
-    // Perform the set computation
-    void operator()() const
+    // Perform the set computation and return the fraction of pixels actually iterated
+    Real operator()() const
     {
-        Image img(side * side);
-        for (std::size_t x = 0; x < side; ++x) {
-            for (std::size_t y = 0; y < side; ++y) {
-                getPixel(img, x, y) = computeElement(x, y);
-            }
-        }
+        Image img(side);
+        const std::size_t evaluated = render(img);
 
         #ifdef SAVE_IMAGE
         static std::size_t imgId = 0;
@@ -71,13 +312,15 @@ struct Mandelbrot
         // Export it to png
         for (std::size_t x = 0; x < side; ++x) {
             for (std::size_t y = 0; y < side; ++y) {
-                png.setPixel(x, y, getPixel(img, x, y) == inSetColor ? sf::Color::Black : sf::Color::White);
+                png.setPixel(x, y, img.getPixel(x, y) == inSetColor ? sf::Color::Black : sf::Color::White);
             }
         }
 
         png.saveToFile("tmp/fractal_" + std::to_string(imgId) + "_" + csvdescription() + ".png");
         ++imgId;
         #endif
+
+        return static_cast<Real>(evaluated) / img.size();
     }
     
     std::string csvdescription() const 
@@ -85,38 +328,956 @@ struct Mandelbrot
         std::stringstream ss;
         ss << side << "," 
            << maxIterations << "," 
-           << range;
+           << range << ","
+           << threads << ","
+           << isaName(isa) << ","
+           << (interiorChecks ? "interior" : "brute") << ","
+           << (renderer == Renderer::RECTANGLES ? "rectangles" : "pixels") << ","
+           << Precision<Real>::name();
         return ss.str();
     }
 
-    // Compute the color of one element of the set
-    Color computeElement(std::size_t x, std::size_t y) const
+    // Compute the whole image
+    //
+    // The image is split into tiles that are distributed dynamically to the threads :
+    // the cost of a pixel inside the set is much higher than outside so a static
+    // split would leave most threads idle while a few handle the interior.
+    //
+    // Only the rows held by img are computed, which allows rendering one band at a time.
+    //
+    // Return the number of pixels that were actually iterated
+    std::size_t render(Image& img) const
+    {
+        const std::size_t tilesPerRow = (side + tileSide - 1) / tileSide;
+        const std::size_t tilesPerColumn = (img.height() + tileSide - 1) / tileSide;
+        std::vector<std::size_t> evaluated(tilesPerRow * tilesPerColumn);
+
+        parallelFor(evaluated.size(), threads, [&](std::size_t tile) {
+            const std::size_t x0 = (tile % tilesPerRow) * tileSide;
+            const std::size_t y0 = img.firstRow() + (tile / tilesPerRow) * tileSide;
+
+            if (renderer == Renderer::RECTANGLES) {
+                Subdivision subdivision(*this, img, x0, y0);
+                evaluated[tile] = subdivision.run();
+            } else {
+                renderTile(img, x0, y0);
+                evaluated[tile] = (std::min(x0 + tileSide, side) - x0) * (std::min(y0 + tileSide, img.endRow()) - y0);
+            }
+        });
+
+        return std::accumulate(evaluated.begin(), evaluated.end(), std::size_t(0));
+    }
+
+    // Mariani–Silver subdivision of one tile
+    //
+    // The border of a rectangle is evaluated first; if it has a single color the
+    // whole rectangle is filled with it (the set is connected so it cannot have
+    // a hole or an island inside such a border, up to the pixel resolution).
+    // Otherwise the rectangle is split in two halves sharing their middle line.
+    struct Subdivision
+    {
+        Subdivision(Mandelbrot const& mandelbrot, Image& img, std::size_t x0, std::size_t y0)
+        : mandelbrot(mandelbrot)
+        , img(img)
+        , x0(x0)
+        , y0(y0)
+        , x1(std::min(x0 + tileSide, mandelbrot.side))
+        , y1(std::min(y0 + tileSide, img.endRow()))
+        , known((x1 - x0) * (y1 - y0), false)
+        , evaluated(0)
+        { /* - */ }
+
+        // Compute the tile and return the number of pixels iterated
+        std::size_t run()
+        {
+            rectangle(x0, y0, x1 - 1, y1 - 1);
+            return evaluated;
+        }
+
+        // Compute the rectangle whose corners (inclusive) are (ax, ay) and (bx, by)
+        void rectangle(std::size_t ax, std::size_t ay, std::size_t bx, std::size_t by)
+        {
+            const Color color = evaluate(ax, ay);
+            bool uniform = true;
+            for (std::size_t x = ax; x <= bx; ++x) {
+                uniform &= evaluate(x, ay) == color;
+                uniform &= evaluate(x, by) == color;
+            }
+            for (std::size_t y = ay; y <= by; ++y) {
+                uniform &= evaluate(ax, y) == color;
+                uniform &= evaluate(bx, y) == color;
+            }
+
+            if (uniform) {
+                for (std::size_t y = ay + 1; y < by; ++y) {
+                    for (std::size_t x = ax + 1; x < bx; ++x) {
+                        fill(x, y, color);
+                    }
+                }
+            } else if (bx - ax < minRectangleSide || by - ay < minRectangleSide) {
+                for (std::size_t y = ay + 1; y < by; ++y) {
+                    for (std::size_t x = ax + 1; x < bx; ++x) {
+                        evaluate(x, y);
+                    }
+                }
+            } else if (bx - ax >= by - ay) {
+                const std::size_t mx = (ax + bx) / 2;
+                rectangle(ax, ay, mx, by);
+                rectangle(mx, ay, bx, by);
+            } else {
+                const std::size_t my = (ay + by) / 2;
+                rectangle(ax, ay, bx, my);
+                rectangle(ax, my, bx, by);
+            }
+        }
+
+        // Iterate pixel (x, y) unless it is already known
+        Color evaluate(std::size_t x, std::size_t y)
+        {
+            const std::size_t index = (y - y0) * (x1 - x0) + (x - x0);
+            if (!known[index]) {
+                known[index] = true;
+                img.setPixel(x, y, mandelbrot.computeElement(x, y));
+                ++evaluated;
+            }
+            return img.getPixel(x, y);
+        }
+
+        // Set pixel (x, y) without iterating it
+        void fill(std::size_t x, std::size_t y, Color color)
+        {
+            known[(y - y0) * (x1 - x0) + (x - x0)] = true;
+            img.setPixel(x, y, color);
+        }
+
+        Mandelbrot const& mandelbrot;
+        Image& img;
+        const std::size_t x0, y0, x1, y1;
+        std::vector<bool> known;
+        std::size_t evaluated;
+    };
+
+    // Compute the tile whose top left corner is (x0, y0)
+    //
+    // The tile is as wide as a word of the image so each row is written at once.
+    void renderTile(Image& img, std::size_t x0, std::size_t y0) const
+    {
+        const std::size_t x1 = std::min(x0 + tileSide, side);
+        const std::size_t y1 = std::min(y0 + tileSide, img.endRow());
+        const std::size_t count = x1 - x0;
+        const std::size_t wordIndex = x0 / Image::wordBits;
+
+        if (isa == Isa::SCALAR) {
+            for (std::size_t y = y0; y < y1; ++y) {
+                Image::Word word = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    word |= static_cast<Image::Word>(computeElement(x0 + i, y)) << i;
+                }
+                img.setWord(wordIndex, y, word);
+            }
+            return;
+        }
+
+        // The real parts are shared by all the rows of the tile; the last
+        // lane group is padded by repeating the last point
+        Real cr[tileSide];
+        bool inSet[tileSide];
+        for (std::size_t i = 0; i < tileSide; ++i) {
+            cr[i] = point(std::min(x0 + i, x1 - 1), y0).real();
+        }
+
+        for (std::size_t y = y0; y < y1; ++y) {
+            if (interiorChecks) {
+                escapeRowInterior(isa, cr, point(x0, y).imag(), count, maxIterations, inSet);
+            } else {
+                escapeRow<false>(isa, cr, point(x0, y).imag(), count, maxIterations, inSet);
+            }
+
+            Image::Word word = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                word |= static_cast<Image::Word>(inSet[i] ? inSetColor : notInSetColor) << i;
+            }
+            img.setWord(wordIndex, y, word);
+        }
+    }
+
+    // Point of the complex plane associated with pixel (x, y)
+    Complex point(std::size_t x, std::size_t y) const
     {
-        const Complex c {
-            range.first.real() + x / (side - 1.0) * (range.second.real() - range.first.real()),
-            range.first.imag() + y / (side - 1.0) * (range.second.imag() - range.first.imag())
+        return {
+            range.first.real() + Real(x) / (side - Real(1)) * (range.second.real() - range.first.real()),
+            range.first.imag() + Real(y) / (side - Real(1)) * (range.second.imag() - range.first.imag())
         };
+    }
+
+    // Number of pixels that differ from the brute-force computation
+    std::size_t verify() const
+    {
+        const Mandelbrot reference(side, maxIterations, range, threads);
+        Image expected(side), actual(side);
+        reference.render(expected);
+        render(actual);
+
+        return expected.countDifferences(actual);
+    }
+
+    // Compute the value of one element of the set; see BinaryOutput & co.
+    template <typename Output = BinaryOutput>
+    typename Output::Value computeElement(std::size_t x, std::size_t y) const
+    {
+        const Complex c = point(x, y);
+
+        if (interiorChecks) {
+            if (isInterior(c.real(), c.imag())) {
+                return Output::value(maxIterations, maxIterations, Real(0), Real(0));
+            }
+
+            Real zr, zi;
+            const std::size_t iter = iterateScalar<true>(c.real(), c.imag(), maxIterations, zr, zi);
+            return Output::value(iter, maxIterations, zr, zi);
+        }
 
         Complex z = { 0, 0 };
 
+        // |z|² < 4 is equivalent to |z| < 2 without computing a square root
         std::size_t iter = 0;
-        for (iter = 0; iter < maxIterations && std::abs(z) < 2.0; ++iter) {
+        for (iter = 0; iter < maxIterations && z.real() * z.real() + z.imag() * z.imag() < Real(4); ++iter) {
             z = z * z + c;
         }
 
-        return iter == maxIterations ? inSetColor : notInSetColor;
+        return Output::value(iter, maxIterations, z.real(), z.imag());
+    }
+
+    // Compute the value of every pixel of img
+    template <typename Output>
+    void renderValues(ValueImage<typename Output::Value>& img) const
+    {
+        const std::size_t tilesPerRow = (side + tileSide - 1) / tileSide;
+        const std::size_t tilesPerColumn = (img.height() + tileSide - 1) / tileSide;
+
+        parallelFor(tilesPerRow * tilesPerColumn, threads, [&](std::size_t tile) {
+            const std::size_t x0 = (tile % tilesPerRow) * tileSide;
+            const std::size_t y0 = img.firstRow() + (tile / tilesPerRow) * tileSide;
+
+            for (std::size_t y = y0; y < std::min(y0 + tileSide, img.endRow()); ++y) {
+                for (std::size_t x = x0; x < std::min(x0 + tileSide, side); ++x) {
+                    img.pixel(x, y) = computeElement<Output>(x, y);
+                }
+            }
+        });
+    }
+
+    std::size_t side, maxIterations;
+    ComplexRange<Real> range;
+    std::size_t threads;
+    Isa isa;
+    bool interiorChecks;
+    Renderer renderer;
+};
+
+
+// Write row y of an image in PBM format
+//
+// PBM rows are packed with the first pixel in the most significant bit, 1 being black
+void writePBMRow(std::ostream& out, Image const& band, std::size_t y, std::vector<char>& bytes)
+{
+    for (std::size_t b = 0; b < bytes.size(); ++b) {
+        const unsigned int pixels = (band.getWord(b / 8, y) >> (b % 8 * 8)) & 0xFF;
+
+        unsigned int byte = 0;
+        for (std::size_t bit = 0; bit < 8; ++bit) {
+            const bool black = static_cast<Color>((pixels >> bit) & 1) == inSetColor;
+            byte |= static_cast<unsigned int>(black) << (7 - bit);
+        }
+        bytes[b] = static_cast<char>(byte);
+    }
+    out.write(bytes.data(), bytes.size());
+}
+
+// Render a set band by band straight to a PBM file
+//
+// Only one band of the image is held in memory at a time so the size of the
+// image is only limited by the disk. The band height is the largest multiple
+// of the tile side that fits in the memory budget, or a single row when the
+// budget is smaller than that.
+template <typename Real>
+struct MandelbrotStream
+{
+    MandelbrotStream(Mandelbrot<Real> const& mandelbrot, std::size_t memoryBudget, std::string const& path)
+    : mandelbrot(mandelbrot)
+    , memoryBudget(memoryBudget)
+    , path(path)
+    { /* - */ }
+
+    // Perform the set computation and return the fraction of pixels actually iterated
+    Real operator()() const
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+
+        const std::size_t side = mandelbrot.side;
+        out << "P4\n" << side << " " << side << "\n";
+
+        const std::size_t height = bandHeight();
+        std::vector<char> bytes((side + 7) / 8);
+        std::size_t evaluated = 0;
+
+        for (std::size_t first = 0; first < side; first += height) {
+            Image band(side, std::min(height, side - first), first);
+            evaluated += mandelbrot.render(band);
+
+            for (std::size_t y = band.firstRow(); y < band.endRow(); ++y) {
+                writePBMRow(out, band, y, bytes);
+            }
+        }
+
+        return static_cast<Real>(evaluated) / (side * side);
+    }
+
+    std::string csvdescription() const
+    {
+        std::stringstream ss;
+        ss << mandelbrot.csvdescription() << ","
+           << memoryBudget << ","
+           << bandHeight();
+        return ss.str();
+    }
+
+    // Number of rows rendered at once
+    std::size_t bandHeight() const
+    {
+        const std::size_t rows = memoryBudget / Image::rowBytes(mandelbrot.side);
+        const std::size_t height = rows >= tileSide ? rows / tileSide * tileSide : std::max<std::size_t>(rows, 1);
+        return std::min(height, mandelbrot.side);
+    }
+
+    Mandelbrot<Real> mandelbrot;
+    std::size_t memoryBudget;
+    std::string path;
+};
+
+
+// Compute the per-pixel values of a set, see BinaryOutput & co.
+template <typename Real, typename Output>
+struct MandelbrotValues
+{
+    MandelbrotValues(Mandelbrot<Real> const& mandelbrot)
+    : mandelbrot(mandelbrot)
+    { /* - */ }
+
+    // Perform the set computation
+    void operator()() const
+    {
+        ValueImage<typename Output::Value> img(mandelbrot.side, mandelbrot.side);
+        mandelbrot.template renderValues<Output>(img);
+
+        #ifdef ESCAPE_IMAGE
+        static std::size_t imgId = 0;
+        save("tmp/escape_" + std::to_string(imgId) + "_" + csvdescription(), img);
+        ++imgId;
+        #endif
+    }
+
+    std::string csvdescription() const
+    {
+        return mandelbrot.csvdescription() + "," + Output::name();
+    }
+
+    template <typename Count>
+    void save(std::string const& path, ValueImage<Count> const& img) const
+    {
+        writePGM(path + ".pgm", img, mandelbrot.maxIterations);
+    }
+
+    void save(std::string const& path, ValueImage<float> const& img) const
+    {
+        writePFM(path + ".pfm", img);
+    }
+
+    Mandelbrot<Real> mandelbrot;
+};
+
+
+// Statistics of a tile cache
+struct TileCacheReport
+{
+    std::size_t hits;    // tiles reused as they were
+    std::size_t resumed; // tiles whose pending pixels were iterated further
+    std::size_t misses;  // tiles computed from scratch
+};
+
+std::ostream& operator<<(std::ostream& out, TileCacheReport const& report)
+{
+    return out << report.hits << "," << report.resumed << "," << report.misses;
+}
+
+// Cache of rendered tiles for interactive exploration (pans, zooms)
+//
+// The pixels of a view lie on a grid of step 2^-level anchored at 0 and the grid
+// is cut into tileSide x tileSide tiles, so two views at the same level share the
+// tiles they overlap whatever the pan. A tile is keyed by its grid coordinates
+// and level; it keeps for every pixel the number of iterations done and the last
+// value of its orbit. When a view asks for more iterations than a tile has, only
+// the pixels that have not escaped yet are iterated further from their stored z.
+//
+// The least recently used tiles are dropped when the memory budget is exceeded.
+template <typename Real>
+class TileCache
+{
+public:
+    TileCache(std::size_t memoryBudget, std::size_t threads = 1, bool interiorChecks = true)
+    : capacity(memoryBudget / tileBytes())
+    , threads(threads)
+    , interiorChecks(interiorChecks)
+    , report_({0, 0, 0})
+    { /* - */ }
+
+    // Render the side x side view centered on (centerReal, centerImag) with
+    // 2^level pixels per unit; the center is rounded to the nearest grid point
+    void render(Image& img, Real centerReal, Real centerImag, int level, std::size_t maxIterations)
+    {
+        const std::int64_t side = img.side();
+        const Real step = pixelStep(level);
+        const std::int64_t left = static_cast<std::int64_t>(std::llround(centerReal / step)) - side / 2;
+        const std::int64_t top = static_cast<std::int64_t>(std::llround(-centerImag / step)) - side / 2;
+
+        // Look up the tiles covering the view and collect those that need work
+        std::vector<std::pair<Key, Tile*> > tiles, pending;
+        for (std::int64_t ty = tileIndex(top); ty <= tileIndex(top + side - 1); ++ty) {
+            for (std::int64_t tx = tileIndex(left); tx <= tileIndex(left + side - 1); ++tx) {
+                const Key key = { tx, ty, level };
+                Tile& tile = lookup(key, maxIterations);
+                tiles.push_back({ key, &tile });
+                if (tile.iterations < maxIterations) {
+                    pending.push_back({ key, &tile });
+                }
+            }
+        }
+
+        // Distinct tiles never share data so they can be advanced concurrently
+        parallelFor(pending.size(), threads, [&](std::size_t i) {
+            advance(pending[i].first, *pending[i].second, maxIterations);
+        });
+
+        for (auto const& entry: tiles) {
+            blit(img, entry.first, *entry.second, left, top, maxIterations);
+        }
+
+        trim();
+    }
+
+    TileCacheReport const& report() const { return report_; }
+
+    // Number of tiles held
+    std::size_t size() const { return tiles_.size(); }
+
+    // Memory used by one tile
+    static std::size_t tileBytes()
+    {
+        return tileSide * tileSide * (sizeof(std::size_t) + 2 * sizeof(Real));
+    }
+
+private:
+    struct Key
+    {
+        std::int64_t x, y;
+        int level;
+
+        bool operator<(Key const& other) const
+        {
+            return std::tie(level, y, x) < std::tie(other.level, other.y, other.x);
+        }
+    };
+
+    // A pixel is pending when its count equals the iterations of its tile;
+    // a smaller count is its escape iteration
+    struct Tile
+    {
+        std::size_t iterations;
+        std::vector<std::size_t> count;
+        std::vector<Real> zr, zi;
+        typename std::list<Key>::iterator use; // position in the LRU list
+    };
+
+    // Pixels detected inside the cardioid or the period-2 bulb never escape
+    static constexpr std::size_t interior = std::numeric_limits<std::size_t>::max();
+
+    static Real pixelStep(int level)
+    {
+        return std::ldexp(Real(1), -level);
+    }
+
+    // Index of the tile holding grid coordinate i, rounding towards -∞
+    static std::int64_t tileIndex(std::int64_t i)
+    {
+        const std::int64_t s = tileSide;
+        return i >= 0 ? i / s : -((-i + s - 1) / s);
+    }
+
+    // Find or create a tile and mark it as the most recently used
+    Tile& lookup(Key const& key, std::size_t maxIterations)
+    {
+        auto it = tiles_.find(key);
+        if (it == tiles_.end()) {
+            ++report_.misses;
+            Tile& tile = tiles_[key];
+            tile.iterations = 0;
+            tile.count.assign(tileSide * tileSide, 0);
+            tile.zr.assign(tileSide * tileSide, Real(0));
+            tile.zi.assign(tileSide * tileSide, Real(0));
+            uses.push_front(key);
+            tile.use = uses.begin();
+            return tile;
+        }
+
+        Tile& tile = it->second;
+        if (tile.iterations >= maxIterations) {
+            ++report_.hits;
+        } else {
+            ++report_.resumed;
+        }
+        uses.splice(uses.begin(), uses, tile.use);
+        return tile;
+    }
+
+    // Iterate the pending pixels of a tile up to maxIterations
+    void advance(Key const& key, Tile& tile, std::size_t maxIterations) const
+    {
+        const Real step = pixelStep(key.level);
+
+        for (std::size_t ly = 0; ly < tileSide; ++ly) {
+            const Real ci = -static_cast<Real>(key.y * std::int64_t(tileSide) + std::int64_t(ly)) * step;
+
+            for (std::size_t lx = 0; lx < tileSide; ++lx) {
+                const std::size_t i = ly * tileSide + lx;
+                if (tile.count[i] != tile.iterations) {
+                    continue; // escaped or interior
+                }
+
+                const Real cr = static_cast<Real>(key.x * std::int64_t(tileSide) + std::int64_t(lx)) * step;
+                if (tile.iterations == 0 && interiorChecks && isInterior(cr, ci)) {
+                    tile.count[i] = interior;
+                    continue;
+                }
+
+                tile.count[i] = resumeScalar(cr, ci, tile.iterations, maxIterations, tile.zr[i], tile.zi[i]);
+            }
+        }
+
+        tile.iterations = maxIterations;
+    }
+
+    // Copy the part of a tile that lies in the view
+    static void blit(Image& img, Key const& key, Tile const& tile, std::int64_t left, std::int64_t top, std::size_t maxIterations)
+    {
+        const std::int64_t side = img.side();
+        const std::int64_t x0 = key.x * std::int64_t(tileSide) - left;
+        const std::int64_t y0 = key.y * std::int64_t(tileSide) - top;
+
+        for (std::int64_t y = std::max<std::int64_t>(y0, 0); y < std::min<std::int64_t>(y0 + tileSide, side); ++y) {
+            for (std::int64_t x = std::max<std::int64_t>(x0, 0); x < std::min<std::int64_t>(x0 + tileSide, side); ++x) {
+                const std::size_t count = tile.count[(y - y0) * tileSide + (x - x0)];
+                img.setPixel(x, y, count >= maxIterations ? inSetColor : notInSetColor);
+            }
+        }
+    }
+
+    // Drop the least recently used tiles that do not fit in the budget
+    void trim()
+    {
+        while (tiles_.size() > capacity) {
+            tiles_.erase(uses.back());
+            uses.pop_back();
+        }
+    }
+
+    std::size_t capacity, threads;
+    bool interiorChecks;
+    TileCacheReport report_;
+    std::map<Key, Tile> tiles_;
+    std::list<Key> uses; // most recently used first
+};
+
+template <typename Real>
+constexpr std::size_t TileCache<Real>::interior;
+
+
+// Scripted exploration session : pans, iterations raised, zoom in and back out
+//
+// With cached = false the tiles are dropped after every view, which gives the
+// cost of rendering each view from scratch.
+template <typename Real>
+struct MandelbrotExploration
+{
+    MandelbrotExploration(std::size_t side, int level, std::size_t threads, bool cached, std::size_t memoryBudget)
+    : side(side)
+    , level(level)
+    , threads(threads)
+    , cached(cached)
+    , memoryBudget(memoryBudget)
+    { /* - */ }
+
+    // Perform the session and return the tile statistics
+    TileCacheReport operator()() const
+    {
+        TileCache<Real> cache(cached ? memoryBudget : 0, threads);
+        Image img(side);
+
+        const Real pan = tileSide * std::ldexp(Real(1), -level);
+        Real re = Real(-0.75), im = Real(0);
+        std::size_t maxIterations = 250;
+
+        cache.render(img, re, im, level, maxIterations);
+
+        // Pan right then back left
+        for (std::size_t i = 0; i < 4; ++i) {
+            re += pan;
+            cache.render(img, re, im, level, maxIterations);
+        }
+        for (std::size_t i = 0; i < 4; ++i) {
+            re -= pan;
+            cache.render(img, re, im, level, maxIterations);
+        }
+
+        // Raise the iterations
+        while (maxIterations < 4000) {
+            maxIterations *= 2;
+            cache.render(img, re, im, level, maxIterations);
+        }
+
+        // Zoom in and back out
+        cache.render(img, re, im, level + 1, maxIterations);
+        cache.render(img, re, im, level, maxIterations);
+
+        #ifdef EXPLORE_ZOOM
+        static std::size_t imgId = 0;
+        std::ofstream out("tmp/explore_" + std::to_string(imgId) + ".pbm", std::ios::binary);
+        out << "P4\n" << side << " " << side << "\n";
+        std::vector<char> bytes((side + 7) / 8);
+        for (std::size_t y = 0; y < side; ++y) {
+            writePBMRow(out, img, y, bytes);
+        }
+        ++imgId;
+        #endif
+
+        return cache.report();
+    }
+
+    std::string csvdescription() const
+    {
+        std::stringstream ss;
+        ss << side << ","
+           << level << ","
+           << threads << ","
+           << (cached ? "cached" : "uncached") << ","
+           << memoryBudget << ","
+           << Precision<Real>::name();
+        return ss.str();
+    }
+
+    std::size_t side;
+    int level;
+    std::size_t threads;
+    bool cached;
+    std::size_t memoryBudget;
+};
+
+
+// Statistics of a deep zoom rendering
+struct DeepZoomReport
+{
+    std::size_t skipped;    // iterations skipped by the series approximation
+    std::size_t references; // reference orbits computed
+    std::size_t glitches;   // pixels left without a reliable reference
+};
+
+std::ostream& operator<<(std::ostream& out, DeepZoomReport const& report)
+{
+    return out << report.skipped << "," << report.references << "," << report.glitches;
+}
+
+// Deep zoom around a point given with arbitrary precision, rendered with perturbation
+//
+// A reference orbit Z_n is computed with BigFixed at the center of the image and
+// every pixel c = C + δc only iterates, in double, its difference δz_n = z_n - Z_n :
+//
+//     δz_{n+1} = 2 Z_n δz_n + δz_n² + δc
+//
+// which is accurate as long as δc is representable, that is for radii down to
+// about 1e-300. The first iterations are shared by all pixels and skipped with
+// the series approximation δz_n ≈ A_n δc + B_n δc² + C_n δc³.
+//
+// A pixel whose orbit gets much closer to 0 than the reference (a glitch), or
+// which outlives the reference orbit, is computed again with a new reference
+// taken among such pixels.
+struct DeepZoom
+{
+    typedef double Real;
+    typedef std::complex<Real> Complex;
+
+    DeepZoom(std::size_t side, std::size_t maxIterations,
+             std::string const& centerReal, std::string const& centerImag, Real radius,
+             std::size_t threads = 1)
+    : side(side)
+    , maxIterations(maxIterations)
+    , centerReal(centerReal)
+    , centerImag(centerImag)
+    , radius(radius)
+    , threads(threads)
+    { /* - */ }
+
+    // Perform the set computation
+    DeepZoomReport operator()() const
+    {
+        Image img(side);
+        const DeepZoomReport report = render(img);
+
+        #ifdef DEEP_ZOOM
+        static std::size_t imgId = 0;
+        std::ofstream out("tmp/deep_" + std::to_string(imgId) + ".pbm", std::ios::binary);
+        out << "P4\n" << side << " " << side << "\n";
+        std::vector<char> bytes((side + 7) / 8);
+        for (std::size_t y = 0; y < side; ++y) {
+            writePBMRow(out, img, y, bytes);
+        }
+        ++imgId;
+        #endif
+
+        return report;
+    }
+
+    std::string csvdescription() const
+    {
+        std::stringstream ss;
+        ss << side << ","
+           << maxIterations << ","
+           << "(" << centerReal << ";" << centerImag << ")" << ","
+           << radius << ","
+           << threads;
+        return ss.str();
+    }
+
+    // Outcome of the iteration of a pixel relative to a reference orbit
+    enum class Status { IN_SET, ESCAPED, GLITCHED };
+
+    // Pixels whose |z|² falls below this fraction of |Z|² are glitched
+    static constexpr Real glitchTolerance = 1e-6;
+
+    // The series is used while its cubic term stays below this fraction of the linear one
+    static constexpr Real seriesTolerance = 1e-6;
+
+    // Give up on the remaining glitches after that many references
+    static constexpr std::size_t maxReferences = 16;
+
+    DeepZoomReport render(Image& img) const
+    {
+        DeepZoomReport report = { 0, 1, 0 };
+
+        // Primary reference at the center, with the series approximation
+        const std::vector<Complex> orbit = referenceOrbit(Complex(0, 0));
+        Complex a(0, 0), b(0, 0), c(0, 0);
+        report.skipped = series(orbit, a, b, c);
+
+        std::vector<std::vector<std::size_t> > glitchedPerRow(side);
+        parallelFor(side, threads, [&](std::size_t y) {
+            for (std::size_t i = 0; i < img.wordsPerRow(); ++i) {
+                Image::Word word = 0;
+                for (std::size_t x = i * Image::wordBits; x < std::min((i + 1) * Image::wordBits, side); ++x) {
+                    const Complex dc = delta(x, y);
+                    const Complex dz = dc * (a + dc * (b + dc * c));
+                    const Status status = iterate(orbit, dc, dz, report.skipped);
+
+                    if (status == Status::GLITCHED) {
+                        glitchedPerRow[y].push_back(x);
+                    }
+                    word |= static_cast<Image::Word>(status == Status::IN_SET ? inSetColor : notInSetColor) << (x % Image::wordBits);
+                }
+                img.setWord(i, y, word);
+            }
+        });
+
+        std::vector<std::pair<std::size_t, std::size_t> > glitched;
+        for (std::size_t y = 0; y < side; ++y) {
+            for (auto const& x: glitchedPerRow[y]) {
+                glitched.push_back({ x, y });
+            }
+        }
+
+        // Secondary references, without series approximation
+        while (!glitched.empty() && report.references < maxReferences) {
+            const Complex offset = delta(glitched.front().first, glitched.front().second);
+            const std::vector<Complex> secondary = referenceOrbit(offset);
+            ++report.references;
+
+            std::vector<Status> statuses(glitched.size());
+            parallelFor(glitched.size(), threads, [&](std::size_t i) {
+                const Complex dc = delta(glitched[i].first, glitched[i].second) - offset;
+                statuses[i] = iterate(secondary, dc, Complex(0, 0), 0);
+            });
+
+            std::vector<std::pair<std::size_t, std::size_t> > remaining;
+            for (std::size_t i = 0; i < glitched.size(); ++i) {
+                img.setPixel(glitched[i].first, glitched[i].second, statuses[i] == Status::IN_SET ? inSetColor : notInSetColor);
+                if (statuses[i] == Status::GLITCHED) {
+                    remaining.push_back(glitched[i]);
+                }
+            }
+            glitched.swap(remaining);
+        }
+
+        report.glitches = glitched.size();
+        return report;
+    }
+
+    // Offset of pixel (x, y) from the center; the top row has the largest imaginary part
+    Complex delta(std::size_t x, std::size_t y) const
+    {
+        return {
+            -radius + x / (side - 1.0) * 2 * radius,
+             radius - y / (side - 1.0) * 2 * radius
+        };
+    }
+
+    // Orbit of center + offset, computed with enough precision for the radius,
+    // up to the first escaped value or maxIterations values
+    std::vector<Complex> referenceOrbit(Complex const& offset) const
+    {
+        // Enough bits for the radius, plus a margin for the pixels and the rounding
+        const std::size_t limbs = BigFixed::limbsFor(std::max(0.0, -std::log2(radius)) + 64);
+
+        const BigFixed cr = BigFixed::parse(centerReal, limbs) + BigFixed::fromDouble(offset.real(), limbs);
+        const BigFixed ci = BigFixed::parse(centerImag, limbs) + BigFixed::fromDouble(offset.imag(), limbs);
+        BigFixed zr(limbs), zi(limbs);
+
+        std::vector<Complex> orbit;
+        orbit.reserve(maxIterations);
+        for (std::size_t n = 0; n < maxIterations; ++n) {
+            const Complex z(zr.toDouble(), zi.toDouble());
+            orbit.push_back(z);
+            if (z.real() * z.real() + z.imag() * z.imag() >= 4.0) {
+                break;
+            }
+
+            const BigFixed zrzi = zr * zi;
+            zr = zr * zr - zi * zi + cr;
+            zi = zrzi + zrzi + ci;
+        }
+
+        return orbit;
+    }
+
+    // Compute the series coefficients A, B, C along the orbit for as long as the
+    // approximation holds over the whole image; return the number of iterations skipped
+    std::size_t series(std::vector<Complex> const& orbit, Complex& a, Complex& b, Complex& c) const
+    {
+        const Real r = radius * std::sqrt(2.0); // largest |δc|
+
+        std::size_t n = 0;
+        while (n + 1 < orbit.size() && n + 1 < maxIterations) {
+            const Complex z2 = Real(2) * orbit[n];
+            const Complex na = z2 * a + Real(1);
+            const Complex nb = z2 * b + a * a;
+            const Complex nc = z2 * c + Real(2) * a * b;
+
+            // Written to avoid underflows with tiny radii; also stops on overflows
+            if (!(std::abs(nc) * r * r <= seriesTolerance * std::abs(na))) {
+                break;
+            }
+
+            a = na;
+            b = nb;
+            c = nc;
+            ++n;
+        }
+
+        return n;
+    }
+
+    // Iterate δz from iteration n, relative to the given reference orbit
+    Status iterate(std::vector<Complex> const& orbit, Complex const& dc, Complex dz, std::size_t n) const
+    {
+        for (; n < maxIterations; ++n) {
+            if (n >= orbit.size()) {
+                return Status::GLITCHED; // the reference escaped first
+            }
+
+            const Complex& reference = orbit[n];
+            const Complex z = reference + dz;
+            const Real norm = z.real() * z.real() + z.imag() * z.imag();
+            if (norm >= 4.0) {
+                return Status::ESCAPED;
+            }
+            if (norm < glitchTolerance * (reference.real() * reference.real() + reference.imag() * reference.imag())) {
+                return Status::GLITCHED;
+            }
+
+            dz = dz * (Real(2) * reference + dz) + dc;
+        }
+
+        return Status::IN_SET;
     }
 
     std::size_t side, maxIterations;
-    ComplexRange range;
+    std::string centerReal, centerImag;
+    Real radius;
+    std::size_t threads;
 };
 
 
-int main(int, const char**)
+// The rectangle renderer evaluates its pixels one at a time with the scalar kernel,
+// and types without vector kernels (long double) always use the scalar one
+template <typename Real>
+bool isUsed(Isa isa, Renderer renderer)
+{
+    return isa == Isa::SCALAR || (renderer == Renderer::PIXELS && HasVectorKernels<Real>::value);
+}
+
+// Check the optimised modes against the brute-force computation with a given precision;
+// the output is 'csvdescription()',mismatches
+template <typename Real>
+void verifyAll(std::vector<std::size_t> const& sides, std::vector<std::size_t> const& iterations,
+               std::vector<ComplexRange<double> > const& ranges, std::vector<Isa> const& isas)
+{
+    for (auto const& side: sides)
+        for (auto const& maxIterations: iterations)
+            for (auto const& range: ranges)
+                for (auto const& isa: isas)
+                    for (bool interiorChecks: { false, true })
+                        for (auto renderer: { Renderer::PIXELS, Renderer::RECTANGLES }) {
+                            if (side > 800) continue; // keep the verification short
+                            if (!isUsed<Real>(isa, renderer)) continue;
+
+                            const Mandelbrot<Real> mandelbrot(side, maxIterations, convertRange<Real>(range), hardwareThreads(), isa, interiorChecks, renderer);
+                            std::cout << mandelbrot.csvdescription() << "," << mandelbrot.verify() << std::endl;
+                        }
+}
+
+// Run the benchmark with a given precision
+template <typename Real>
+void benchmarkAll(std::vector<std::size_t> const& sides, std::vector<std::size_t> const& iterations,
+                  std::vector<ComplexRange<double> > const& ranges, std::vector<std::size_t> const& threadCounts,
+                  std::vector<Isa> const& isas, std::size_t repetitions)
+{
+    for (auto const& side: sides)
+        for (auto const& maxIterations: iterations)
+            for (auto const& range: ranges)
+                for (auto const& threads: threadCounts)
+                    for (auto const& isa: isas)
+                        for (bool interiorChecks: { false, true })
+                            for (auto renderer: { Renderer::PIXELS, Renderer::RECTANGLES })
+                                if (isUsed<Real>(isa, renderer))
+                                    stats<Mandelbrot<Real>, Real>({side, maxIterations, convertRange<Real>(range), threads, isa, interiorChecks, renderer}, (maxIterations >= 1000 && side >= 2000 ? 1 : repetitions));
+}
+
+int main(int argc, const char** argv)
 {
+    typedef std::complex<double> Complex;
+
     const std::vector<std::size_t> sides = { 100, 200, 400, 800, 1200, 1600, 2000, 4000, 10000 };
     const std::vector<std::size_t> iterations = { 1, 10, 30, 80, 150, 250, 500, 1000, 2000, 8000 };
-    const std::vector<ComplexRange> ranges = {
+    const std::vector<ComplexRange<double> > ranges = {
         { Complex(-1.72, 1.2), Complex(1.0, -1.2) },
         { Complex(-0.7, 0), Complex(0.3, -1) },
         { Complex(-0.4, -0.5), Complex(0.1, -1) },
@@ -124,17 +1285,130 @@ int main(int, const char**)
         { Complex(-0.24, -0.64), Complex(-0.26, -0.66) }
     };
 
+    std::vector<std::size_t> threadCounts = { 1 };
+    if (hardwareThreads() > 1) {
+        threadCounts.push_back(hardwareThreads());
+    }
+
+    // Report the scalar and the best SIMD kernel side by side
+    std::vector<Isa> isas = { Isa::SCALAR };
+    if (detectIsa() != Isa::SCALAR) {
+        isas.push_back(detectIsa());
+    }
+
+    #ifdef STREAM_IMAGE
+    // Render very large images to tmp/ band by band;
+    // the memory budget is given in MiB as first argument (default 64 MiB)
+    const std::size_t memoryBudget = (argc > 1 ? std::stoul(argv[1]) : 64) * 1024 * 1024;
+    const std::vector<std::size_t> streamedSides = { 10000, 40000, 100000 };
+
+    for (auto const& side: streamedSides) {
+        const Mandelbrot<double> mandelbrot(side, 250, ranges.front(), hardwareThreads(), isas.back(), true);
+        std::stringstream path;
+        path << "tmp/fractal_" << side << ".pbm";
+        stats<MandelbrotStream<double>, double>({mandelbrot, memoryBudget, path.str()});
+    }
+
+    return 0;
+    #else
+    (void)argc; (void)argv;
+    #endif
+
+    #ifdef ESCAPE_IMAGE
+    // Render iteration counts and smooth iteration counts to tmp/
+    for (auto const& maxIterations: { 250, 1000, 8000 })
+        for (auto const& range: ranges) {
+            const Mandelbrot<double> mandelbrot(2000, maxIterations, range, hardwareThreads(), Isa::SCALAR, true);
+            stats<MandelbrotValues<double, CountOutput<std::uint16_t> >, void>(mandelbrot);
+            stats<MandelbrotValues<double, CountOutput<std::uint32_t> >, void>(mandelbrot);
+            stats<MandelbrotValues<double, SmoothOutput>, void>(mandelbrot);
+        }
+
+    return 0;
+    #endif
+
+    #ifdef EXPLORE_ZOOM
+    // Replay an exploration session with and without the tile cache;
+    // the memory budget is given in MiB as first argument (default 256 MiB)
+    const std::size_t cacheBudget = (argc > 1 ? std::stoul(argv[1]) : 256) * 1024 * 1024;
+
+    for (auto const& side: { 512, 1024, 2048 })
+        for (auto const& threads: threadCounts)
+            for (bool cached: { false, true }) {
+                stats<MandelbrotExploration<double>, TileCacheReport>({std::size_t(side), 9, threads, cached, cacheBudget}, 4);
+            }
+
+    return 0;
+    #endif
+
+    #ifdef DEEP_ZOOM
+    // Zoom into two points down to radii well beyond double precision;
+    // the images are saved in tmp/
+    const std::vector<std::pair<std::string, std::string> > centers = {
+        { "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139" },
+        { "0", "1" } // Misiurewicz point, its neighbourhood is detailed at any depth
+    };
+    const std::vector<double> radii = { 1e-5, 1e-10, 1e-20, 1e-30, 1e-50, 1e-100 };
+
+    for (auto const& center: centers)
+        for (auto const& radius: radii)
+            stats<DeepZoom, DeepZoomReport>({1000, 8000, center.first, center.second, radius, hardwareThreads()});
+
+    return 0;
+    #endif
+
+    #ifdef VERIFY_IMAGE
+    // Check the perturbation against the direct computation where double precision is enough
+    for (auto const& radius: { 1e-2, 1e-4, 1e-6 }) {
+        const double re = -0.743643887037158704752191506114774, im = 0.131825904205311970493132056385139;
+        const DeepZoom deepZoom(400, 2000, "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", radius, hardwareThreads());
+        const Mandelbrot<double> mandelbrot(400, 2000, { Complex(re - radius, im + radius), Complex(re + radius, im - radius) }, hardwareThreads());
+
+        Image expected(400), actual(400);
+        mandelbrot.render(expected);
+        deepZoom.render(actual);
+        std::cout << deepZoom.csvdescription() << "," << expected.countDifferences(actual) << std::endl;
+    }
+
+    // Check the tile cache against the direct computation, both for fresh and resumed tiles;
+    // the output is side,maxIter,mismatches fresh,mismatches resumed
+    for (auto const& side: { 100, 400, 1000 })
+        for (auto const& maxIterations: { 30, 500, 2000 }) {
+            const int level = 8;
+            const double step = std::ldexp(1.0, -level);
+            const double re = -0.75, im = 0.1;
+            const double left = (std::llround(re / step) - side / 2) * step;
+            const double top = -(std::llround(-im / step) - side / 2) * step;
+            const Mandelbrot<double> mandelbrot(side, maxIterations, { Complex(left, top), Complex(left + (side - 1) * step, top - (side - 1) * step) });
+
+            TileCache<double> fresh(256 * 1024 * 1024), resumed(256 * 1024 * 1024);
+            Image expected(side), actual(side), actualResumed(side);
+            mandelbrot.render(expected);
+            fresh.render(actual, re, im, level, maxIterations);
+            resumed.render(actualResumed, re, im, level, 10);
+            resumed.render(actualResumed, re + 0.5, im, level, maxIterations / 2);
+            resumed.render(actualResumed, re, im, level, maxIterations);
+            std::cout << side << "," << maxIterations << ","
+                      << expected.countDifferences(actual) << ","
+                      << expected.countDifferences(actualResumed) << std::endl;
+        }
+
+    verifyAll<float>(sides, iterations, ranges, isas);
+    verifyAll<double>(sides, iterations, ranges, isas);
+    verifyAll<long double>(sides, iterations, ranges, isas);
+
+    return 0;
+    #endif
+
     #ifdef SAVE_IMAGE
     const std::size_t repetitions = 1;
     #else
     const std::size_t repetitions = 4;
     #endif
 
-    for (auto const& side: sides)
-        for (auto const& maxIterations: iterations)
-            for (auto const& range: ranges)
-                stats<Mandelbrot, void>({side, maxIterations, range}, (maxIterations >= 1000 && side >= 2000 ? 1 : repetitions));
+    benchmarkAll<float>(sides, iterations, ranges, threadCounts, isas, repetitions);
+    benchmarkAll<double>(sides, iterations, ranges, threadCounts, isas, repetitions);
+    benchmarkAll<long double>(sides, iterations, ranges, threadCounts, isas, repetitions);
 
     return 0;
 }
-
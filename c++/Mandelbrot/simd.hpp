@@ -0,0 +1,435 @@
+
+#ifndef MANDELBROT_SIMD_HPP
+#define MANDELBROT_SIMD_HPP
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define MANDELBROT_X86
+    #include <immintrin.h>
+#endif
+
+//
+// Escape-time kernels iterating several pixels of the same row at once
+//
+// Each lane checks |z|² < 4 (no square root) before every iteration and
+// stops contributing as soon as its orbit escapes; the group stops when
+// every lane has escaped. The arithmetic is the same as the scalar kernel,
+// without fused multiply-add, so the results are bit-identical.
+//
+// There are vector kernels for float and double, float having twice as many
+// lanes; other types (long double) always use the scalar kernel.
+//
+
+// Instruction set used by the kernels
+enum class Isa {
+    SCALAR,
+    AVX2,
+    AVX512
+};
+
+inline std::string isaName(Isa isa)
+{
+    switch (isa) {
+        case Isa::AVX512: return "avx512";
+        case Isa::AVX2:   return "avx2";
+        default:          return "scalar";
+    }
+}
+
+// Best instruction set supported by the running CPU
+inline Isa detectIsa()
+{
+    #ifdef MANDELBROT_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+    #endif
+    return Isa::SCALAR;
+}
+
+// Is there a vector kernel for Real ?
+template <typename Real>
+struct HasVectorKernels : std::integral_constant<bool,
+    std::is_same<Real, float>::value || std::is_same<Real, double>::value>
+{ /* - */ };
+
+// Number of pixels handled at once by the given instruction set
+template <typename Real>
+inline std::size_t laneCount(Isa isa)
+{
+    if (!HasVectorKernels<Real>::value) {
+        return 1;
+    }
+
+    switch (isa) {
+        case Isa::AVX512: return 64 / sizeof(Real);
+        case Isa::AVX2:   return 32 / sizeof(Real);
+        default:          return 1;
+    }
+}
+
+// Is c inside the main cardioid or the period-2 bulb ?
+//
+// Those points are in the set and never escape, whatever the number of iterations.
+template <typename Real>
+inline bool isInterior(Real cr, Real ci)
+{
+    const Real xq = cr - Real(0.25);
+    const Real ci2 = ci * ci;
+    const Real q = xq * xq + ci2;
+    if (q * (q + xq) <= Real(0.25) * ci2) {
+        return true;
+    }
+
+    const Real xb = cr + Real(1);
+    return xb * xb + ci2 <= Real(0.0625);
+}
+
+//
+// Periodicity checking (Brent) : z is saved at every power of two iterations
+// and compared to the following values. An orbit that comes back exactly to
+// a saved value cycles forever and never escapes, so the point is in the set.
+// Only exact equality is used so the result is the same as without the check.
+//
+
+// Reference kernel : one pixel at a time
+//
+// Return the number of iterations done before escaping, maxIterations if the
+// point is in the set, and leave the last value of the orbit in (zr, zi).
+template <bool Periodicity, typename Real>
+inline std::size_t iterateScalar(Real cr, Real ci, std::size_t maxIterations, Real& zr, Real& zi)
+{
+    zr = 0;
+    zi = 0;
+    Real savedr = 0, savedi = 0;
+    std::size_t period = 0, limit = 1;
+
+    std::size_t iter = 0;
+    for (iter = 0; iter < maxIterations && zr * zr + zi * zi < Real(4); ++iter) {
+        const Real zrzi = zr * zi;
+        zr = (zr * zr - zi * zi) + cr;
+        zi = (zrzi + zrzi) + ci;
+
+        if (Periodicity) {
+            if (zr == savedr && zi == savedi) {
+                return maxIterations;
+            }
+            if (++period == limit) {
+                period = 0;
+                limit *= 2;
+                savedr = zr;
+                savedi = zi;
+            }
+        }
+    }
+
+    return iter;
+}
+
+// Continue an orbit from its iteration `first`, whose value is in (zr, zi)
+//
+// Return the same count as iterateScalar<false> would for the whole orbit, and
+// leave the last value of the orbit in (zr, zi) so that it can be resumed again.
+template <typename Real>
+inline std::size_t resumeScalar(Real cr, Real ci, std::size_t first, std::size_t maxIterations, Real& zr, Real& zi)
+{
+    std::size_t iter = first;
+    for (; iter < maxIterations && zr * zr + zi * zi < Real(4); ++iter) {
+        const Real zrzi = zr * zi;
+        zr = (zr * zr - zi * zi) + cr;
+        zi = (zrzi + zrzi) + ci;
+    }
+
+    return iter;
+}
+
+template <bool Periodicity, typename Real>
+inline void escapeScalar(Real const* cr, Real ci, std::size_t maxIterations, bool* inSet)
+{
+    Real zr, zi;
+    *inSet = iterateScalar<Periodicity>(*cr, ci, maxIterations, zr, zi) == maxIterations;
+}
+
+#ifdef MANDELBROT_X86
+
+// 4 doubles per iteration
+//
+// A lane is active until it escapes; with periodicity checking the lanes that
+// cycled stay active but no longer prevent the group from stopping.
+template <bool Periodicity>
+__attribute__((target("avx2")))
+inline void escapeAVX2(double const* cr, double ci, std::size_t maxIterations, bool* inSet)
+{
+    const __m256d four = _mm256_set1_pd(4.0);
+    const __m256d cre = _mm256_loadu_pd(cr);
+    const __m256d cim = _mm256_set1_pd(ci);
+
+    __m256d zr = _mm256_setzero_pd();
+    __m256d zi = _mm256_setzero_pd();
+    __m256d active = _mm256_cmp_pd(zr, zr, _CMP_EQ_OQ); // all lanes set
+
+    __m256d savedr = zr, savedi = zi;
+    __m256d cycled = _mm256_setzero_pd();
+    std::size_t period = 0, limit = 1;
+
+    for (std::size_t iter = 0; iter < maxIterations; ++iter) {
+        const __m256d zr2 = _mm256_mul_pd(zr, zr);
+        const __m256d zi2 = _mm256_mul_pd(zi, zi);
+        active = _mm256_and_pd(active, _mm256_cmp_pd(_mm256_add_pd(zr2, zi2), four, _CMP_LT_OQ));
+        if (_mm256_movemask_pd(_mm256_andnot_pd(cycled, active)) == 0) {
+            break;
+        }
+
+        const __m256d zrzi = _mm256_mul_pd(zr, zi);
+        zr = _mm256_add_pd(_mm256_sub_pd(zr2, zi2), cre);
+        zi = _mm256_add_pd(_mm256_add_pd(zrzi, zrzi), cim);
+
+        if (Periodicity) {
+            const __m256d same = _mm256_and_pd(_mm256_cmp_pd(zr, savedr, _CMP_EQ_OQ),
+                                               _mm256_cmp_pd(zi, savedi, _CMP_EQ_OQ));
+            cycled = _mm256_or_pd(cycled, _mm256_and_pd(same, active));
+            if (++period == limit) {
+                period = 0;
+                limit *= 2;
+                savedr = zr;
+                savedi = zi;
+            }
+        }
+    }
+
+    const int mask = _mm256_movemask_pd(active);
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+        inSet[lane] = (mask >> lane) & 1;
+    }
+}
+
+// 8 doubles per iteration
+template <bool Periodicity>
+__attribute__((target("avx512f")))
+inline void escapeAVX512(double const* cr, double ci, std::size_t maxIterations, bool* inSet)
+{
+    const __m512d four = _mm512_set1_pd(4.0);
+    const __m512d cre = _mm512_loadu_pd(cr);
+    const __m512d cim = _mm512_set1_pd(ci);
+
+    __m512d zr = _mm512_setzero_pd();
+    __m512d zi = _mm512_setzero_pd();
+    __mmask8 active = 0xFF;
+
+    __m512d savedr = zr, savedi = zi;
+    __mmask8 cycled = 0;
+    std::size_t period = 0, limit = 1;
+
+    for (std::size_t iter = 0; iter < maxIterations; ++iter) {
+        const __m512d zr2 = _mm512_mul_pd(zr, zr);
+        const __m512d zi2 = _mm512_mul_pd(zi, zi);
+        active = _mm512_mask_cmp_pd_mask(active, _mm512_add_pd(zr2, zi2), four, _CMP_LT_OQ);
+        if ((active & ~cycled) == 0) {
+            break;
+        }
+
+        const __m512d zrzi = _mm512_mul_pd(zr, zi);
+        zr = _mm512_add_pd(_mm512_sub_pd(zr2, zi2), cre);
+        zi = _mm512_add_pd(_mm512_add_pd(zrzi, zrzi), cim);
+
+        if (Periodicity) {
+            const __mmask8 same = _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(zr, savedr, _CMP_EQ_OQ),
+                                                          zi, savedi, _CMP_EQ_OQ);
+            cycled |= same & active;
+            if (++period == limit) {
+                period = 0;
+                limit *= 2;
+                savedr = zr;
+                savedi = zi;
+            }
+        }
+    }
+
+    for (std::size_t lane = 0; lane < 8; ++lane) {
+        inSet[lane] = (active >> lane) & 1;
+    }
+}
+
+// 8 floats per iteration
+template <bool Periodicity>
+__attribute__((target("avx2")))
+inline void escapeAVX2(float const* cr, float ci, std::size_t maxIterations, bool* inSet)
+{
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 cre = _mm256_loadu_ps(cr);
+    const __m256 cim = _mm256_set1_ps(ci);
+
+    __m256 zr = _mm256_setzero_ps();
+    __m256 zi = _mm256_setzero_ps();
+    __m256 active = _mm256_cmp_ps(zr, zr, _CMP_EQ_OQ); // all lanes set
+
+    __m256 savedr = zr, savedi = zi;
+    __m256 cycled = _mm256_setzero_ps();
+    std::size_t period = 0, limit = 1;
+
+    for (std::size_t iter = 0; iter < maxIterations; ++iter) {
+        const __m256 zr2 = _mm256_mul_ps(zr, zr);
+        const __m256 zi2 = _mm256_mul_ps(zi, zi);
+        active = _mm256_and_ps(active, _mm256_cmp_ps(_mm256_add_ps(zr2, zi2), four, _CMP_LT_OQ));
+        if (_mm256_movemask_ps(_mm256_andnot_ps(cycled, active)) == 0) {
+            break;
+        }
+
+        const __m256 zrzi = _mm256_mul_ps(zr, zi);
+        zr = _mm256_add_ps(_mm256_sub_ps(zr2, zi2), cre);
+        zi = _mm256_add_ps(_mm256_add_ps(zrzi, zrzi), cim);
+
+        if (Periodicity) {
+            const __m256 same = _mm256_and_ps(_mm256_cmp_ps(zr, savedr, _CMP_EQ_OQ),
+                                              _mm256_cmp_ps(zi, savedi, _CMP_EQ_OQ));
+            cycled = _mm256_or_ps(cycled, _mm256_and_ps(same, active));
+            if (++period == limit) {
+                period = 0;
+                limit *= 2;
+                savedr = zr;
+                savedi = zi;
+            }
+        }
+    }
+
+    const int mask = _mm256_movemask_ps(active);
+    for (std::size_t lane = 0; lane < 8; ++lane) {
+        inSet[lane] = (mask >> lane) & 1;
+    }
+}
+
+// 16 floats per iteration
+template <bool Periodicity>
+__attribute__((target("avx512f")))
+inline void escapeAVX512(float const* cr, float ci, std::size_t maxIterations, bool* inSet)
+{
+    const __m512 four = _mm512_set1_ps(4.0f);
+    const __m512 cre = _mm512_loadu_ps(cr);
+    const __m512 cim = _mm512_set1_ps(ci);
+
+    __m512 zr = _mm512_setzero_ps();
+    __m512 zi = _mm512_setzero_ps();
+    __mmask16 active = 0xFFFF;
+
+    __m512 savedr = zr, savedi = zi;
+    __mmask16 cycled = 0;
+    std::size_t period = 0, limit = 1;
+
+    for (std::size_t iter = 0; iter < maxIterations; ++iter) {
+        const __m512 zr2 = _mm512_mul_ps(zr, zr);
+        const __m512 zi2 = _mm512_mul_ps(zi, zi);
+        active = _mm512_mask_cmp_ps_mask(active, _mm512_add_ps(zr2, zi2), four, _CMP_LT_OQ);
+        if ((active & ~cycled) == 0) {
+            break;
+        }
+
+        const __m512 zrzi = _mm512_mul_ps(zr, zi);
+        zr = _mm512_add_ps(_mm512_sub_ps(zr2, zi2), cre);
+        zi = _mm512_add_ps(_mm512_add_ps(zrzi, zrzi), cim);
+
+        if (Periodicity) {
+            const __mmask16 same = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(zr, savedr, _CMP_EQ_OQ),
+                                                           zi, savedi, _CMP_EQ_OQ);
+            cycled |= same & active;
+            if (++period == limit) {
+                period = 0;
+                limit *= 2;
+                savedr = zr;
+                savedi = zi;
+            }
+        }
+    }
+
+    for (std::size_t lane = 0; lane < 16; ++lane) {
+        inSet[lane] = (active >> lane) & 1;
+    }
+}
+
+#endif // MANDELBROT_X86
+
+// Compute one lane group with the given instruction set; types without
+// vector kernels fall back to the scalar one
+template <bool Periodicity, typename Real>
+inline void escapeGroup(Isa, Real const* cr, Real ci, std::size_t maxIterations, bool* inSet)
+{
+    escapeScalar<Periodicity>(cr, ci, maxIterations, inSet);
+}
+
+template <bool Periodicity>
+inline void escapeGroup(Isa isa, double const* cr, double ci, std::size_t maxIterations, bool* inSet)
+{
+    switch (isa) {
+        #ifdef MANDELBROT_X86
+        case Isa::AVX512: escapeAVX512<Periodicity>(cr, ci, maxIterations, inSet); break;
+        case Isa::AVX2:   escapeAVX2<Periodicity>(cr, ci, maxIterations, inSet);   break;
+        #endif
+        default:          escapeScalar<Periodicity>(cr, ci, maxIterations, inSet); break;
+    }
+}
+
+template <bool Periodicity>
+inline void escapeGroup(Isa isa, float const* cr, float ci, std::size_t maxIterations, bool* inSet)
+{
+    switch (isa) {
+        #ifdef MANDELBROT_X86
+        case Isa::AVX512: escapeAVX512<Periodicity>(cr, ci, maxIterations, inSet); break;
+        case Isa::AVX2:   escapeAVX2<Periodicity>(cr, ci, maxIterations, inSet);   break;
+        #endif
+        default:          escapeScalar<Periodicity>(cr, ci, maxIterations, inSet); break;
+    }
+}
+
+/*!
+ * Determine which points of a row are in the set
+ *
+ * @param isa instruction set to use; must be supported by the CPU
+ * @param cr real parts of the points, padded to a multiple of laneCount<Real>(isa)
+ * @param ci imaginary part shared by all the points
+ * @param count number of points, padding excluded
+ * @param maxIterations iteration limit
+ * @param inSet output flags, padded like cr
+ */
+template <bool Periodicity, typename Real>
+inline void escapeRow(Isa isa, Real const* cr, Real ci, std::size_t count, std::size_t maxIterations, bool* inSet)
+{
+    const std::size_t lanes = laneCount<Real>(isa);
+
+    for (std::size_t i = 0; i < count; i += lanes) {
+        escapeGroup<Periodicity>(isa, cr + i, ci, maxIterations, inSet + i);
+    }
+}
+
+/*!
+ * Same as escapeRow but with interior detection and periodicity checking
+ *
+ * The lane groups whose points all lie in the main cardioid or in the
+ * period-2 bulb are not iterated at all.
+ */
+template <typename Real>
+inline void escapeRowInterior(Isa isa, Real const* cr, Real ci, std::size_t count, std::size_t maxIterations, bool* inSet)
+{
+    const std::size_t lanes = laneCount<Real>(isa);
+
+    for (std::size_t i = 0; i < count; i += lanes) {
+        bool interior = true;
+        for (std::size_t lane = 0; lane < lanes && interior; ++lane) {
+            interior = isInterior(cr[i + lane], ci);
+        }
+
+        if (interior) {
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+                inSet[i + lane] = true;
+            }
+        } else {
+            escapeRow<true>(isa, cr + i, ci, lanes, maxIterations, inSet + i);
+        }
+    }
+}
+
+#endif // MANDELBROT_SIMD_HPP
@@ -6,17 +6,56 @@
 #include <vector>
 #include <algorithm>
 #include <sstream>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstdint>
 #include "stats.hpp"
-
-typedef double Real;
+#include "precision.hpp"
+#include "Random/Uniform.hpp"
+#include "Random/Bits.hpp"
+#include "Random/LowDiscrepancy.hpp"
 
 namespace mc {
     
-    typedef std::pair<Real, Real> Point;
-    typedef std::uniform_real_distribution<Real> RealDistribution;
     typedef std::default_random_engine RandomEngine;
 
+    // How the points are chosen
+    enum class Sampling {
+        PSEUDO,          // pseudo-random points
+        SOBOL,           // Sobol sequence
+        SCRAMBLED_SOBOL, // independent random digital shifts of the Sobol sequence
+        HALTON           // Halton sequence in bases 2 and 3
+    };
+
+    // Number of randomised copies of the Sobol sequence
+    constexpr std::size_t replicaCount = 8;
+
+    const long double PI = 3.141592653589793238462643383279502884L;
+
+    // Estimation of π with the standard error of the estimation when it can be computed
+    template <typename Real>
+    struct Approximation
+    {
+        Real pi;
+        Real standardError; // NaN for the deterministic sequences
+    };
+
+    template <typename Real>
+    std::ostream& operator<<(std::ostream& out, Approximation<Real> const& approximation)
+    {
+        out << approximation.pi << "," << std::fabs(approximation.pi - PI) << ",";
+        if (!std::isnan(approximation.standardError)) {
+            out << approximation.standardError;
+        }
+        return out;
+    }
+
+    template <typename Real>
     Real computePi(std::size_t pointCount) {
+        typedef std::pair<Real, Real> Point;
+        typedef std::uniform_real_distribution<Real> RealDistribution;
+
         // Define two random number generators gX and gY
         RandomEngine algoX, algoY;
         std::random_device rd;
@@ -45,25 +84,119 @@ namespace mc {
 
         return pi;
     }
+
+    // Same with pointCount points of a Sobol sequence, digitally shifted by `shift`
+    template <typename Real>
+    Real computePiSobol(std::size_t pointCount, std::vector<std::uint32_t> const& shift = {}) {
+        Sobol sequence(2);
+        sequence.setShift(shift);
+
+        std::size_t sum = 0;
+        std::uint32_t u[2];
+        for (std::size_t i = 0; i < pointCount; ++i) {
+            sequence.next(u);
+            const Real x = unitFromBits<Real>(std::uint64_t(u[0]) << 32);
+            const Real y = unitFromBits<Real>(std::uint64_t(u[1]) << 32);
+            if (x * x + y * y <= 1) {
+                ++sum;
+            }
+        }
+
+        return static_cast<Real>(sum) / pointCount * 4;
+    }
+
+    // Same with pointCount points of the Halton sequence
+    template <typename Real>
+    Real computePiHalton(std::size_t pointCount) {
+        Halton<Real> sequence(2);
+
+        std::size_t sum = 0;
+        Real p[2];
+        for (std::size_t i = 0; i < pointCount; ++i) {
+            sequence.next(p);
+            if (p[0] * p[0] + p[1] * p[1] <= 1) {
+                ++sum;
+            }
+        }
+
+        return static_cast<Real>(sum) / pointCount * 4;
+    }
+
+    template <typename Real>
+    Approximation<Real> approximatePi(std::size_t pointCount, Sampling sampling) {
+        const Real nan = std::numeric_limits<Real>::quiet_NaN();
+
+        switch (sampling) {
+            case Sampling::SOBOL:
+                return { computePiSobol<Real>(pointCount), nan };
+
+            case Sampling::HALTON:
+                return { computePiHalton<Real>(pointCount), nan };
+
+            case Sampling::SCRAMBLED_SOBOL: {
+                // The copies are independent so the spread of their results gives the error
+                const std::size_t replicas = std::min(replicaCount, pointCount);
+                RandomContext& random = RandomContext::current();
+
+                std::vector<Real> estimations;
+                for (std::size_t r = 0; r < replicas; ++r) {
+                    const std::vector<std::uint32_t> shift = {
+                        uniform<std::uint32_t>(random, 0, ~std::uint32_t(0)),
+                        uniform<std::uint32_t>(random, 0, ~std::uint32_t(0))
+                    };
+                    estimations.push_back(computePiSobol<Real>(pointCount / replicas, shift));
+                }
+
+                const Real mean = std::accumulate(estimations.begin(), estimations.end(), Real(0)) / replicas;
+                Real variance = 0;
+                for (auto const& e: estimations) {
+                    variance += (e - mean) * (e - mean);
+                }
+                variance /= replicas > 1 ? replicas - 1 : 1;
+
+                return { mean, std::sqrt(variance / replicas) };
+            }
+
+            default: {
+                // Binomial : each point is inside with probability π/4
+                const Real pi = computePi<Real>(pointCount);
+                const Real p = pi / 4;
+                return { pi, 4 * std::sqrt(p * (1 - p) / pointCount) };
+            }
+        }
+    }
 }
 
+std::string samplingName(mc::Sampling sampling)
+{
+    switch (sampling) {
+        case mc::Sampling::SOBOL:           return "sobol";
+        case mc::Sampling::SCRAMBLED_SOBOL: return "scrambled-sobol";
+        case mc::Sampling::HALTON:          return "halton";
+        default:                            return "pseudo";
+    }
+}
+
+template <typename Real>
 struct MonteCarlo
 {
-    MonteCarlo(std::size_t pointCount)
+    MonteCarlo(std::size_t pointCount, mc::Sampling sampling)
     : pointCount(pointCount)
+    , sampling(sampling)
     { /* - */ }
 
-    Real operator()() const {
-        return mc::computePi(pointCount);
+    mc::Approximation<Real> operator()() const {
+        return mc::approximatePi<Real>(pointCount, sampling);
     }
 
     std::string csvdescription() const {
         std::stringstream ss;
-        ss << "C++#1," << pointCount;
+        ss << "C++#1," << Precision<Real>::name() << "," << samplingName(sampling) << "," << pointCount;
         return ss.str();
     }
 
     std::size_t pointCount;
+    mc::Sampling sampling;
 };
 
 int main(int argc, const char * argv[])
@@ -71,7 +204,11 @@ int main(int argc, const char * argv[])
     // Benchmark count from 2^7 to 2^22
     for (std::size_t c = 128; c <= 4194304; c *= 2) {
         // Do 100 measurements for low point count
-        stats<MonteCarlo, Real>(MonteCarlo(c), 100);
+        for (auto sampling: { mc::Sampling::PSEUDO, mc::Sampling::SOBOL, mc::Sampling::SCRAMBLED_SOBOL, mc::Sampling::HALTON }) {
+            stats<MonteCarlo<float>, mc::Approximation<float> >(MonteCarlo<float>(c, sampling), 100);
+            stats<MonteCarlo<double>, mc::Approximation<double> >(MonteCarlo<double>(c, sampling), 100);
+            stats<MonteCarlo<long double>, mc::Approximation<long double> >(MonteCarlo<long double>(c, sampling), 100);
+        }
     }
 
     return 0;
@@ -6,17 +6,31 @@
 #include <vector>
 #include <algorithm>
 #include <sstream>
+#include <array>
 #include "stats.hpp"
-
-typedef double Real;
+#include "precision.hpp"
+#include "allocation.hpp"
+#include "Random/Xoshiro.hpp"
 
 namespace mc {
 
-    typedef std::pair<Real, Real> Point;
-    typedef std::uniform_real_distribution<Real> RealDistribution;
     typedef std::default_random_engine RandomEngine;
 
-    Real computePi(std::size_t pointCount) {
+    // How the points are generated and counted
+    enum class Pipeline {
+        TWO_PHASE, // all the points are generated, then counted
+        FUSED,     // the points are generated and counted by batches held on the stack
+        VECTORIZED // same as FUSED with the coordinates made by the SIMD batch generator
+    };
+
+    // Points per batch of the fused pipeline; small enough to stay in the L1 cache
+    constexpr std::size_t batchSize = 1024;
+
+    template <typename Real>
+    Real computePi(std::size_t pointCount, Pipeline pipeline) {
+        typedef std::pair<Real, Real> Point;
+        typedef std::uniform_real_distribution<Real> RealDistribution;
+
         // Define two random number generators gX and gY
         RandomEngine algoX, algoY;
         std::random_device rd;
@@ -34,37 +48,93 @@ namespace mc {
             return p.first * p.first + p.second * p.second <= 1;
         };
 
-        // Create some random point in the unit square
-        std::vector<Point> points(pointCount);
-        std::generate(points.begin(), points.end(), randomPoint);
-
-        // Count point inside the circle
-        const auto pointInCircleCount = std::count_if(points.begin(), points.end(), isInside);
+        std::size_t pointInCircleCount = 0;
+
+        if (pipeline == Pipeline::TWO_PHASE) {
+            // Create some random point in the unit square
+            std::vector<Point> points(pointCount);
+            std::generate(points.begin(), points.end(), randomPoint);
+
+            // Count point inside the circle
+            pointInCircleCount = std::count_if(points.begin(), points.end(), isInside);
+        } else if (pipeline == Pipeline::VECTORIZED) {
+            UniformBatch batch((std::uint64_t(rd()) << 32) ^ rd());
+
+            std::array<Real, batchSize> xs, ys;
+            for (std::size_t first = 0; first < pointCount; first += batchSize) {
+                const std::size_t count = std::min(batchSize, pointCount - first);
+                batch.fill(xs.data(), count);
+                batch.fill(ys.data(), count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (xs[i] * xs[i] + ys[i] * ys[i] <= 1) {
+                        ++pointInCircleCount;
+                    }
+                }
+            }
+        } else {
+            // Same steps, one batch at a time
+            std::array<Point, batchSize> points;
+            for (std::size_t first = 0; first < pointCount; first += batchSize) {
+                const std::size_t count = std::min(batchSize, pointCount - first);
+                std::generate_n(points.begin(), count, randomPoint);
+                pointInCircleCount += std::count_if(points.begin(), points.begin() + count, isInside);
+            }
+        }
 
         // π/4 = .785398163
         const Real ratio = static_cast<Real>(pointInCircleCount) / static_cast<Real>(pointCount);
 
-        return ratio * 4.0;
+        return ratio * 4;
     }
 }
 
+std::string pipelineName(mc::Pipeline pipeline)
+{
+    switch (pipeline) {
+        case mc::Pipeline::VECTORIZED: return "vectorized";
+        case mc::Pipeline::FUSED:      return "fused";
+        default:                       return "two-phase";
+    }
+}
+
+// Estimation of π with the number of bytes allocated to compute it
+template <typename Real>
+struct Estimation
+{
+    Real pi;
+    std::size_t allocated;
+};
+
+template <typename Real>
+std::ostream& operator<<(std::ostream& out, Estimation<Real> const& estimation)
+{
+    return out << estimation.pi << "," << estimation.allocated;
+}
+
+template <typename Real>
 struct MonteCarlo
 {
-    MonteCarlo(std::size_t pointCount)
+    MonteCarlo(std::size_t pointCount, mc::Pipeline pipeline)
     : pointCount(pointCount)
+    , pipeline(pipeline)
     { /* - */ }
 
-    Real operator()() const {
-        return mc::computePi(pointCount);
+    Estimation<Real> operator()() const {
+        const std::size_t before = allocatedBytes();
+        const Real pi = mc::computePi<Real>(pointCount, pipeline);
+        return { pi, allocatedBytes() - before };
     }
 
     std::string csvdescription() const {
         std::stringstream ss;
-        ss << "C++#2," << pointCount;
+        ss << "C++#2," << Precision<Real>::name() << ","
+           << pipelineName(pipeline) << ","
+           << pointCount;
         return ss.str();
     }
 
     std::size_t pointCount;
+    mc::Pipeline pipeline;
 };
 
 int main(int argc, const char * argv[])
@@ -72,7 +142,11 @@ int main(int argc, const char * argv[])
     // Benchmark count from 2^7 to 2^22
     for (std::size_t c = 128; c <= 4194304; c *= 2) {
         // Do 100 measurements for low point count
-        stats<MonteCarlo, Real>(MonteCarlo(c), 100);
+        for (auto pipeline: { mc::Pipeline::TWO_PHASE, mc::Pipeline::FUSED, mc::Pipeline::VECTORIZED }) {
+            stats<MonteCarlo<float>, Estimation<float> >(MonteCarlo<float>(c, pipeline), 100);
+            stats<MonteCarlo<double>, Estimation<double> >(MonteCarlo<double>(c, pipeline), 100);
+            stats<MonteCarlo<long double>, Estimation<long double> >(MonteCarlo<long double>(c, pipeline), 100);
+        }
     }
 
     return 0;
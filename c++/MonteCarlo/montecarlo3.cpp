@@ -0,0 +1,318 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <sstream>
+#include <cstdint>
+#include <stdexcept>
+#include "stats.hpp"
+#include "precision.hpp"
+#include "parallel.hpp"
+#include "integration.hpp"
+#include "Random/Philox.hpp"
+
+namespace mc {
+
+    // 1 inside the unit ball, 0 outside
+    template <std::size_t Dimension, typename Real>
+    struct InsideBall
+    {
+        Real operator()(std::array<Real, Dimension> const& x) const {
+            Real r2 = 0;
+            for (std::size_t d = 0; d < Dimension; ++d) {
+                r2 += x[d] * x[d];
+            }
+            return r2 <= 1 ? 1 : 0;
+        }
+    };
+
+    // exp(-|x|²)
+    template <std::size_t Dimension, typename Real>
+    struct Gaussian
+    {
+        Real operator()(std::array<Real, Dimension> const& x) const {
+            Real r2 = 0;
+            for (std::size_t d = 0; d < Dimension; ++d) {
+                r2 += x[d] * x[d];
+            }
+            return std::exp(-r2);
+        }
+    };
+
+    // Number of points among [first, last[ that are inside the circle
+    //
+    // The points are those of integrate(), so the points do not depend on
+    // which thread draws them.
+    template <typename Real>
+    std::size_t countInside(std::size_t first, std::size_t last, Philox4x32::Key const& key) {
+        const InsideBall<2, Real> inside;
+        const Box<2, Real> square = Box<2, Real>::unit();
+
+        std::size_t count = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            if (inside(randomPoint(i, key, square)) != 0) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    // π / 4 is the area of the quarter of the unit disc inside [0, 1]^2
+    template <typename Real>
+    Real computePi(std::size_t pointCount, std::uint64_t seed, std::size_t threads) {
+        const Integral<Real> quarter = integrate(InsideBall<2, Real>(), Box<2, Real>::unit(), pointCount, seed, threads);
+        return quarter.value * 4;
+    }
+
+    // Integral with its exact value
+    template <typename Real>
+    struct Estimation
+    {
+        Integral<Real> integral;
+        Real exact;
+    };
+
+    template <typename Real>
+    std::ostream& operator<<(std::ostream& out, Estimation<Real> const& estimation)
+    {
+        return out << estimation.integral.value << ","
+                   << std::abs(estimation.integral.value - estimation.exact) << ","
+                   << estimation.integral.standardError;
+    }
+
+    // Points per batch of the adaptive estimation
+    constexpr std::size_t batchSize = 1 << 12;
+
+    // Batches computed in parallel before the stopping criterion is checked
+    constexpr std::size_t batchesPerRound = 64;
+
+    // The variance is not trusted before that many batches
+    constexpr std::size_t minBatchCount = 16;
+
+    // Quantile of the normal distribution for a 95% confidence interval
+    constexpr double z95 = 1.959963984540054;
+
+    // Estimation of π with its 95% confidence interval
+    template <typename Real>
+    struct Interval
+    {
+        Real pi;
+        Real halfWidth;
+        std::size_t pointCount; // points used
+    };
+
+    template <typename Real>
+    std::ostream& operator<<(std::ostream& out, Interval<Real> const& interval)
+    {
+        return out << interval.pi << ","
+                   << interval.pi - interval.halfWidth << ","
+                   << interval.pi + interval.halfWidth << ","
+                   << interval.pointCount;
+    }
+
+    // Estimate π until its 95% confidence interval is narrower than targetWidth
+    //
+    // Each batch gives an estimation of π; their mean and variance are updated
+    // with Welford's algorithm and the half-width of the interval is
+    // z95 * sqrt(variance / batches). The batches of a round are computed in
+    // parallel but taken into account in order, stopping at the first one that
+    // meets the target, so the result does not depend on the number of threads.
+    //
+    // The target must be positive, otherwise the estimation would never stop.
+    template <typename Real>
+    Interval<Real> estimatePi(Real targetWidth, std::uint64_t seed, std::size_t threads) {
+        if (!(targetWidth > 0)) { // also rejects NaN
+            throw std::invalid_argument("The target width must be positive");
+        }
+
+        const Philox4x32::Key key = Philox4x32::key(seed);
+
+        std::size_t batches = 0;
+        Real mean = 0, m2 = 0; // running mean and sum of squared deviations
+        std::vector<std::size_t> hits(batchesPerRound);
+
+        while (true) {
+            const std::size_t firstBatch = batches;
+            parallelFor(batchesPerRound, threads, [&](std::size_t b) {
+                const std::size_t first = (firstBatch + b) * batchSize;
+                hits[b] = countInside<Real>(first, first + batchSize, key);
+            });
+
+            for (auto const& count: hits) {
+                const Real estimation = static_cast<Real>(count) / batchSize * 4;
+
+                ++batches;
+                const Real delta = estimation - mean;
+                mean += delta / batches;
+                m2 += delta * (estimation - mean);
+
+                if (batches < minBatchCount) {
+                    continue;
+                }
+
+                const Real halfWidth = Real(z95) * std::sqrt(m2 / (batches - 1) / batches);
+                if (2 * halfWidth <= targetWidth) {
+                    return { mean, halfWidth, batches * batchSize };
+                }
+            }
+        }
+    }
+}
+
+template <typename Real>
+struct MonteCarlo
+{
+    MonteCarlo(std::size_t pointCount, std::size_t threads, std::uint64_t seed)
+    : pointCount(pointCount)
+    , threads(threads)
+    , seed(seed)
+    { /* - */ }
+
+    Real operator()() const {
+        return mc::computePi<Real>(pointCount, seed, threads);
+    }
+
+    std::string csvdescription() const {
+        std::stringstream ss;
+        ss << "C++#3," << Precision<Real>::name() << "," << threads << "," << pointCount;
+        return ss.str();
+    }
+
+    std::size_t pointCount;
+    std::size_t threads;
+    std::uint64_t seed;
+};
+
+// Estimation of π up to a given accuracy
+template <typename Real>
+struct AdaptiveMonteCarlo
+{
+    AdaptiveMonteCarlo(Real targetWidth, std::size_t threads, std::uint64_t seed)
+    : targetWidth(targetWidth)
+    , threads(threads)
+    , seed(seed)
+    { /* - */ }
+
+    mc::Interval<Real> operator()() const {
+        return mc::estimatePi<Real>(targetWidth, seed, threads);
+    }
+
+    std::string csvdescription() const {
+        std::stringstream ss;
+        ss << "C++#3," << Precision<Real>::name() << "," << threads << "," << targetWidth;
+        return ss.str();
+    }
+
+    Real targetWidth;
+    std::size_t threads;
+    std::uint64_t seed;
+};
+
+// Integration of f over a box in Dimension dimensions
+template <std::size_t Dimension, typename Real, typename Integrand>
+struct Integration
+{
+    Integration(std::string name, Box<Dimension, Real> domain, Real exact,
+                std::size_t pointCount, std::size_t threads, std::uint64_t seed)
+    : name(name)
+    , domain(domain)
+    , exact(exact)
+    , pointCount(pointCount)
+    , threads(threads)
+    , seed(seed)
+    { /* - */ }
+
+    mc::Estimation<Real> operator()() const {
+        return { integrate(Integrand(), domain, pointCount, seed, threads), exact };
+    }
+
+    std::string csvdescription() const {
+        std::stringstream ss;
+        ss << "C++#3," << name << "," << Dimension << "," << Precision<Real>::name() << "," << threads << "," << pointCount;
+        return ss.str();
+    }
+
+    std::string name;
+    Box<Dimension, Real> domain;
+    Real exact;
+    std::size_t pointCount;
+    std::size_t threads;
+    std::uint64_t seed;
+};
+
+// Volume of the unit ball and integral of exp(-|x|²) over [0, 1]^Dimension
+template <std::size_t Dimension, typename Real>
+void benchmarkIntegrals(std::size_t pointCount, std::size_t threads, std::uint64_t seed)
+{
+    typedef Integration<Dimension, Real, mc::InsideBall<Dimension, Real> > Ball;
+    typedef Integration<Dimension, Real, mc::Gaussian<Dimension, Real> > Gaussian;
+
+    const long double pi = 3.141592653589793238462643383279502884L;
+    const long double ball = std::pow(pi, Dimension / 2.0L) / std::tgamma(Dimension / 2.0L + 1);
+    const long double gaussian = std::pow(std::sqrt(pi) / 2 * std::erf(1.0L), static_cast<long double>(Dimension));
+
+    stats<Ball, mc::Estimation<Real> >(Ball("ball", Box<Dimension, Real>::cube(-1, 1), Real(ball), pointCount, threads, seed), 10);
+    stats<Gaussian, mc::Estimation<Real> >(Gaussian("gaussian", Box<Dimension, Real>::unit(), Real(gaussian), pointCount, threads, seed), 10);
+}
+
+template <typename Real>
+void benchmarkIntegrals(std::size_t pointCount, std::size_t threads, std::uint64_t seed)
+{
+    benchmarkIntegrals<2, Real>(pointCount, threads, seed);
+    benchmarkIntegrals<3, Real>(pointCount, threads, seed);
+    benchmarkIntegrals<5, Real>(pointCount, threads, seed);
+    benchmarkIntegrals<8, Real>(pointCount, threads, seed);
+}
+
+int main(int argc, const char * argv[])
+{
+    // The seed is fixed so that the estimations can be compared between thread counts
+    const std::uint64_t seed = 20130101;
+
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t t = 1; t < hardwareThreads(); t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(hardwareThreads());
+
+    #ifdef ADAPTIVE
+    // Stop as soon as the 95% confidence interval is narrow enough;
+    // the output is 'csvdescription()',pi,lower bound,upper bound,points used,time
+    for (auto const& width: { 1e-1, 3e-2, 1e-2, 3e-3, 1e-3 }) {
+        for (auto const& threads: threadCounts) {
+            stats<AdaptiveMonteCarlo<float>, mc::Interval<float> >(AdaptiveMonteCarlo<float>(width, threads, seed), 10);
+            stats<AdaptiveMonteCarlo<double>, mc::Interval<double> >(AdaptiveMonteCarlo<double>(width, threads, seed), 10);
+            stats<AdaptiveMonteCarlo<long double>, mc::Interval<long double> >(AdaptiveMonteCarlo<long double>(width, threads, seed), 10);
+        }
+    }
+
+    return 0;
+    #endif
+
+    #ifdef INTEGRATION
+    // Integrals in several dimensions with the generic integrator;
+    // the output is 'csvdescription()',value,|value - exact|,standard error,time
+    for (std::size_t c = 65536; c <= 4194304; c *= 4) {
+        for (auto const& threads: threadCounts) {
+            benchmarkIntegrals<float>(c, threads, seed);
+            benchmarkIntegrals<double>(c, threads, seed);
+            benchmarkIntegrals<long double>(c, threads, seed);
+        }
+    }
+
+    return 0;
+    #endif
+
+    // Benchmark count from 2^7 to 2^22
+    for (std::size_t c = 128; c <= 4194304; c *= 2) {
+        for (auto const& threads: threadCounts) {
+            // Do 100 measurements for low point count
+            stats<MonteCarlo<float>, float>(MonteCarlo<float>(c, threads, seed), 100);
+            stats<MonteCarlo<double>, double>(MonteCarlo<double>(c, threads, seed), 100);
+            stats<MonteCarlo<long double>, long double>(MonteCarlo<long double>(c, threads, seed), 100);
+        }
+    }
+
+    return 0;
+}
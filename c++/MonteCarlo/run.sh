@@ -5,3 +5,9 @@ make
 ./bin/montecarlo1 | tee data1.csv
 
 ./bin/montecarlo2 | tee data2.csv
+
+./bin/montecarlo3 | tee data3.csv
+
+./bin/montecarlo3-adaptive | tee data3-adaptive.csv
+
+./bin/montecarlo3-integration | tee data3-integration.csv
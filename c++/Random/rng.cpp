@@ -0,0 +1,170 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include "stats.hpp"
+#include "precision.hpp"
+#include "Random/Uniform.hpp"
+#include "Random/Philox.hpp"
+#include "Random/Xoshiro.hpp"
+
+//
+// Throughput of the uniform [0, 1) generators, and of two ways to draw
+// normal(0, 1) numbers : fill an array of `count` numbers and return their
+// mean so that the work cannot be optimised away.
+//
+
+enum class Generator {
+    STD,          // std::default_random_engine with std::uniform_real_distribution
+    MT19937,      // std::mt19937_64 with std::uniform_real_distribution
+    PHILOX,       // Philox4x32-10, two numbers per block
+    XOSHIRO,      // scalar xoshiro256+
+    BATCH_SCALAR, // UniformBatch without SIMD
+    BATCH_SIMD,   // UniformBatch with AVX2
+    UNIFORM,      // uniform<T>(0, 1) one number at a time
+    NORMAL_STD,   // std::normal_distribution(0, 1), a new one for each number
+    NORMAL_BATCH  // RandomContext::fillNormal(0, 1)
+};
+
+std::string generatorName(Generator generator)
+{
+    switch (generator) {
+        case Generator::STD:          return "std";
+        case Generator::MT19937:      return "mt19937_64";
+        case Generator::PHILOX:       return "philox";
+        case Generator::XOSHIRO:      return "xoshiro";
+        case Generator::BATCH_SCALAR: return "batch-scalar";
+        case Generator::BATCH_SIMD:   return "batch-simd";
+        case Generator::NORMAL_STD:   return "normal-std";
+        case Generator::NORMAL_BATCH: return "normal-batch";
+        default:                      return "uniform";
+    }
+}
+
+template <typename Real>
+struct RandomFill
+{
+    RandomFill(Generator generator, std::size_t count)
+    : generator(generator)
+    , count(count)
+    , numbers(count)
+    { /* - */ }
+
+    Real operator()() const
+    {
+        const std::uint64_t seed = 20130101;
+        Real* out = numbers.data();
+
+        switch (generator) {
+            case Generator::STD: {
+                std::default_random_engine algo(seed);
+                std::uniform_real_distribution<Real> dist(0, 1);
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = dist(algo);
+                }
+                break;
+            }
+
+            case Generator::MT19937: {
+                std::mt19937_64 algo(seed);
+                std::uniform_real_distribution<Real> dist(0, 1);
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = dist(algo);
+                }
+                break;
+            }
+
+            case Generator::PHILOX: {
+                const Philox4x32::Key key = Philox4x32::key(seed);
+                for (std::size_t i = 0; i < count; i += 2) {
+                    const Philox4x32::Counter r = Philox4x32::block(Philox4x32::counter(i / 2), key);
+                    out[i] = unitFromBits<Real>(r[0], r[1]);
+                    if (i + 1 < count) {
+                        out[i + 1] = unitFromBits<Real>(r[2], r[3]);
+                    }
+                }
+                break;
+            }
+
+            case Generator::XOSHIRO: {
+                Xoshiro256Plus algo(seed);
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = unitFromBits<Real>(algo());
+                }
+                break;
+            }
+
+            case Generator::BATCH_SCALAR:
+            case Generator::BATCH_SIMD: {
+                UniformBatch batch(seed, generator == Generator::BATCH_SIMD);
+                batch.fill(out, count);
+                break;
+            }
+
+            case Generator::NORMAL_STD: {
+                std::default_random_engine algo(seed);
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::normal_distribution<Real> dist(0, 1);
+                    out[i] = dist(algo);
+                }
+                break;
+            }
+
+            case Generator::NORMAL_BATCH: {
+                RandomContext context(seed);
+                context.fillNormal(out, count);
+                break;
+            }
+
+            default:
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = uniform<Real>(0, 1);
+                }
+                break;
+        }
+
+        return std::accumulate(numbers.begin(), numbers.end(), Real(0)) / count;
+    }
+
+    std::string csvdescription() const
+    {
+        std::stringstream ss;
+        ss << generatorName(generator) << ","
+           << Precision<Real>::name() << ","
+           << count;
+        return ss.str();
+    }
+
+    Generator generator;
+    std::size_t count;
+    mutable std::vector<Real> numbers;
+};
+
+template <typename Real>
+void benchmark(std::vector<Generator> const& generators)
+{
+    // Fill from 2^10 to 2^24 numbers
+    for (std::size_t count = 1024; count <= 16777216; count *= 4)
+        for (auto const& generator: generators) {
+            stats<RandomFill<Real>, Real>(RandomFill<Real>(generator, count), 10);
+        }
+}
+
+int main(int, const char**)
+{
+    std::vector<Generator> generators = {
+        Generator::STD, Generator::MT19937, Generator::PHILOX, Generator::XOSHIRO,
+        Generator::BATCH_SCALAR, Generator::UNIFORM, Generator::NORMAL_STD, Generator::NORMAL_BATCH
+    };
+    if (UniformBatch::vectorSupported()) {
+        generators.push_back(Generator::BATCH_SIMD);
+    }
+
+    benchmark<float>(generators);
+    benchmark<double>(generators);
+
+    return 0;
+}
@@ -0,0 +1,5 @@
+#!/bin/sh
+
+make
+
+./bin/rng | tee data.csv
@@ -0,0 +1,186 @@
+#ifndef TRIANGULARMATRIX_BLAS3_HPP
+#define TRIANGULARMATRIX_BLAS3_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include "kernels.hpp"
+
+//
+// Triangular matrix products and solves in the style of BLAS level 3
+//
+// B and C are M x N row-major matrices with leading dimensions ldb and ldc.
+// T is a triangular matrix, M x M when it is on the left and N x N when it is
+// on the right, stored row-major with leading dimension ldt; only its lower
+// or upper triangle is read. op(T) is T or its transpose.
+//
+// Every operation is brought back to A X with A lower or upper triangular on
+// the left : on the right, X op(T) is the transpose of op(T)ᵀ Xᵀ, and the
+// transposes are only different strides over the same storage. The columns
+// of X are then split between the threads and go through the blocked kernel.
+//
+
+enum class Side { LEFT, RIGHT };
+enum class Uplo { LOWER, UPPER };
+enum class Transpose { NO, YES };
+
+inline std::string sideName(Side side) { return side == Side::LEFT ? "left" : "right"; }
+inline std::string uploName(Uplo uplo) { return uplo == Uplo::LOWER ? "lower" : "upper"; }
+inline std::string transposeName(Transpose trans) { return trans == Transpose::NO ? "n" : "t"; }
+
+// Number of floating point operations of trmm or trsm
+inline double triangularFlops(Side side, std::size_t M, std::size_t N)
+{
+    const std::size_t n = side == Side::LEFT ? M : N;
+    return double(n) * double(n + 1) * double(side == Side::LEFT ? N : M);
+}
+
+namespace blas3 {
+
+    // op(T) on the left, or op(T)ᵀ for the right side, read from T
+    struct Triangle
+    {
+        Triangle(Side side, Uplo uplo, Transpose trans, std::size_t ldt)
+        : layout((trans == Transpose::YES) != (side == Side::RIGHT) ? Strided(1, ldt) : Strided(ldt, 1))
+        , lower((uplo == Uplo::LOWER) == ((trans == Transpose::YES) == (side == Side::RIGHT)))
+        { /* - */ }
+
+        Strided layout;
+        bool lower;
+    };
+
+    // B, or Bᵀ for the right side
+    template <typename Real>
+    MatrixView<Real> operand(Side side, Real* B, std::size_t ldb)
+    {
+        const MatrixView<Real> view = { B, ldb, 1 };
+        return side == Side::LEFT ? view : view.transposed();
+    }
+
+    // Rows `rows` and columns `columns` of X = A⁻¹ X, by substitution
+    template <typename Real>
+    void substitute(Triangle const& A, Real const* T, MatrixView<Real> X, Range rows, Range columns)
+    {
+        for (std::size_t n = 0; n < rows.last - rows.first; ++n) {
+            const std::size_t i = A.lower ? rows.first + n : rows.last - 1 - n;
+            const std::size_t first = A.lower ? rows.first : i + 1;
+            const std::size_t last = A.lower ? i : rows.last;
+
+            for (std::size_t k = first; k < last; ++k) {
+                const Real a = T[A.layout(i, k)];
+                for (std::size_t j = columns.first; j < columns.last; ++j) {
+                    X(i, j) -= a * X(k, j);
+                }
+            }
+
+            const Real diagonal = T[A.layout(i, i)];
+            for (std::size_t j = columns.first; j < columns.last; ++j) {
+                X(i, j) /= diagonal;
+            }
+        }
+    }
+}
+
+// Entry (i, k) of op(T), zero outside the triangle
+template <typename Real>
+Real triangleEntry(Uplo uplo, Transpose trans, Real const* T, std::size_t ldt, std::size_t i, std::size_t k)
+{
+    if (trans == Transpose::YES) {
+        std::swap(i, k);
+    }
+    const bool inside = uplo == Uplo::LOWER ? k <= i : i <= k;
+    return inside ? T[i * ldt + k] : Real(0);
+}
+
+// Reference for trmm : one dot product per entry of C
+template <typename Real>
+void naiveTrmm(Side side, Uplo uplo, Transpose trans, std::size_t M, std::size_t N, Real alpha,
+               Real const* T, std::size_t ldt, Real const* B, std::size_t ldb, Real* C, std::size_t ldc)
+{
+    for (std::size_t i = 0; i < M; ++i) {
+        for (std::size_t j = 0; j < N; ++j) {
+            Real sum = 0;
+            if (side == Side::LEFT) {
+                for (std::size_t k = 0; k < M; ++k) {
+                    sum += triangleEntry(uplo, trans, T, ldt, i, k) * B[k * ldb + j];
+                }
+            } else {
+                for (std::size_t k = 0; k < N; ++k) {
+                    sum += B[i * ldb + k] * triangleEntry(uplo, trans, T, ldt, k, j);
+                }
+            }
+            C[i * ldc + j] = alpha * sum;
+        }
+    }
+}
+
+/*!
+ * @brief C = alpha op(T) B (left) or C = alpha B op(T) (right)
+ *
+ * C must not overlap B.
+ */
+template <typename Real>
+void trmm(Side side, Uplo uplo, Transpose trans, std::size_t M, std::size_t N, Real alpha,
+          Real const* T, std::size_t ldt, Real const* B, std::size_t ldb, Real* C, std::size_t ldc,
+          std::size_t threads = 1)
+{
+    const blas3::Triangle A(side, uplo, trans, ldt);
+    const MatrixView<Real const> X = blas3::operand(side, B, ldb);
+    const MatrixView<Real> Y = blas3::operand(side, C, ldc);
+    const std::size_t n = side == Side::LEFT ? M : N; // dimension of T
+    const std::size_t m = side == Side::LEFT ? N : M; // columns of X
+
+    forEachColumnBand(m, BlockedTrmm<Real, Strided>::NR, threads, [&](Range columns) {
+        BlockedTrmm<Real, Strided>().multiply(A.layout, A.lower, T, X, Y, { 0, n }, { 0, n }, columns, alpha, false);
+    });
+}
+
+/*!
+ * @brief Solve op(T) X = alpha B (left) or X op(T) = alpha B (right) for X
+ *
+ * X overwrites B. The diagonal of T must not have zeros.
+ *
+ * Blocks of KC rows of X are solved one after the other, first to last for a
+ * lower triangle and last to first for an upper one : the contribution of
+ * the rows already solved is removed with the blocked kernel and the block
+ * is then solved by substitution.
+ */
+template <typename Real>
+void trsm(Side side, Uplo uplo, Transpose trans, std::size_t M, std::size_t N, Real alpha,
+          Real const* T, std::size_t ldt, Real* B, std::size_t ldb, std::size_t threads = 1)
+{
+    typedef BlockedTrmm<Real, Strided> Engine;
+
+    const blas3::Triangle A(side, uplo, trans, ldt);
+    const MatrixView<Real> X = blas3::operand(side, B, ldb);
+    const MatrixView<Real const> solved = { X.data, X.rowStride, X.colStride };
+    const std::size_t n = side == Side::LEFT ? M : N;
+    const std::size_t m = side == Side::LEFT ? N : M;
+    const std::size_t blocks = (n + Engine::KC - 1) / Engine::KC;
+
+    // The columns of X are independent : each thread solves its band to the end
+    forEachColumnBand(m, Engine::NR, threads, [&](Range columns) {
+        Engine engine;
+
+        if (alpha != Real(1)) {
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = columns.first; j < columns.last; ++j) {
+                    X(i, j) *= alpha;
+                }
+            }
+        }
+
+        for (std::size_t b = 0; b < blocks; ++b) {
+            const std::size_t block = A.lower ? b : blocks - 1 - b;
+            const Range rows = { block * Engine::KC, std::min(n, (block + 1) * Engine::KC) };
+            const Range done = A.lower ? Range{ 0, rows.first } : Range{ rows.last, n };
+
+            if (done.first < done.last) {
+                engine.multiply(A.layout, A.lower, T, solved, X, rows, done, columns, Real(-1), true);
+            }
+            blas3::substitute(A, T, X, rows, columns);
+        }
+    });
+}
+
+#endif // TRIANGULARMATRIX_BLAS3_HPP
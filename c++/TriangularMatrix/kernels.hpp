@@ -0,0 +1,274 @@
+#ifndef TRIANGULARMATRIX_KERNELS_HPP
+#define TRIANGULARMATRIX_KERNELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "parallel.hpp"
+#include "layouts.hpp"
+
+//
+// Kernels computing C = A B where A is an NxN lower triangular matrix stored
+// with one of the layouts of layouts.hpp and B and C are NxN row-major
+// matrices. The layout is a template parameter so that its index
+// computation is inlined in the kernels.
+//
+
+enum class Kernel {
+    NAIVE,  // i-j-k loops, B read column-wise
+    BLOCKED // cache blocks of packed A and B with a register-blocked micro-kernel
+};
+
+inline std::string kernelName(Kernel kernel)
+{
+    switch (kernel) {
+        case Kernel::BLOCKED: return "blocked";
+        default:              return "naive";
+    }
+}
+
+// Number of floating point operations of the product : row i of C needs
+// i + 1 multiplications and additions per column
+inline double trmmFlops(std::size_t N)
+{
+    return double(N) * double(N) * double(N + 1);
+}
+
+template <typename Layout, typename Real>
+void naiveTrmm(std::size_t N, Real const* A, Real const* B, Real* C)
+{
+    const Layout layout(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = 0; j < N; ++j) {
+            Real sum = 0;
+            for (std::size_t k = 0; k <= i; ++k) {
+                sum += A[layout(i, k)] * B[k * N + j];
+            }
+            C[i * N + j] = sum;
+        }
+    }
+}
+
+// Half-open interval of indexes [first, last[
+struct Range
+{
+    std::size_t first, last;
+};
+
+// Strided view of a matrix : entry (i, j) is data[i * rowStride + j * colStride]
+template <typename Real>
+struct MatrixView
+{
+    Real* data;
+    std::size_t rowStride, colStride;
+
+    Real& operator()(std::size_t i, std::size_t j) const { return data[i * rowStride + j * colStride]; }
+
+    // The same storage seen as the transposed matrix
+    MatrixView transposed() const { return { data, colStride, rowStride }; }
+};
+
+/*!
+ * @brief Blocked product in the style of Goto & van de Geijn
+ *
+ * The columns of B are taken NC at a time and its rows KC at a time; that
+ * KC x NC panel is copied into slivers of NR columns so that the
+ * micro-kernel reads it contiguously. For each such panel, MC x KC blocks
+ * of A are copied the same way into slivers of MR rows (zero outside the
+ * triangle) and every MR x NR block of C is updated in registers.
+ *
+ * A only has entries on one side of the diagonal : blocks of A entirely on
+ * the other side are never copied nor multiplied, and the micro-kernel only
+ * goes through the columns of A that are non-zero in its MR rows. This does
+ * about half the work of a full product.
+ */
+template <typename Real, typename Layout = RowPacked>
+class BlockedTrmm
+{
+public:
+    // Register block
+    static constexpr std::size_t MR = 4;
+    static constexpr std::size_t NR = 8;
+
+    // Cache blocks : a sliver of B stays in L1, a block of A in L2 and a panel of B in L3
+    static constexpr std::size_t MC = 128;
+    static constexpr std::size_t KC = 256;
+    static constexpr std::size_t NC = 1024;
+
+    BlockedTrmm()
+    : packedA(MC * KC)
+    , packedB(KC * NC)
+    { /* - */ }
+
+    // C = A B
+    void operator()(std::size_t N, Real const* A, Real const* B, Real* C)
+    {
+        multiply(N, A, B, C, 0, N);
+    }
+
+    // Columns [firstColumn, lastColumn[ of C = A B
+    void multiply(std::size_t N, Real const* A, Real const* B, Real* C, std::size_t firstColumn, std::size_t lastColumn)
+    {
+        const MatrixView<Real const> b = { B, N, 1 };
+        const MatrixView<Real> c = { C, N, 1 };
+        multiply(Layout(N), true, A, b, c, { 0, N }, { 0, N }, { firstColumn, lastColumn }, Real(1), false);
+    }
+
+    /*!
+     * Entries (rows, columns) of C = alpha A B, or C += alpha A B if accumulate is set
+     *
+     * A is lower triangular, or upper triangular if lower is not set, and is
+     * read through layout; only its columns `depth` (and the same rows of B)
+     * take part in the product. C must not overlap the rows `depth` of B.
+     */
+    void multiply(Layout const& layout, bool lower, Real const* A, MatrixView<Real const> B, MatrixView<Real> C,
+                  Range rows, Range depth, Range columns, Real alpha, bool accumulate)
+    {
+        if (!accumulate) {
+            for (std::size_t i = rows.first; i < rows.last; ++i) {
+                for (std::size_t j = columns.first; j < columns.last; ++j) {
+                    C(i, j) = 0;
+                }
+            }
+        }
+
+        for (std::size_t jc = columns.first; jc < columns.last; jc += NC) {
+            const std::size_t nc = std::min(NC, columns.last - jc);
+
+            for (std::size_t pc = depth.first; pc < depth.last; pc += KC) {
+                const std::size_t kc = std::min(KC, depth.last - pc);
+                packB(B, pc, kc, jc, nc);
+
+                // Rows with entries in columns [pc, pc + kc[ of A
+                const std::size_t firstRow = lower ? std::max(rows.first, pc) : rows.first;
+                const std::size_t lastRow = lower ? rows.last : std::min(rows.last, pc + kc);
+
+                for (std::size_t ic = firstRow; ic < lastRow; ic += MC) {
+                    const std::size_t mc = std::min(MC, lastRow - ic);
+                    packA(layout, lower, A, ic, mc, pc, kc);
+
+                    for (std::size_t ir = 0; ir < mc; ir += MR) {
+                        const std::size_t mr = std::min(MR, mc - ir);
+                        const std::size_t i = ic + ir; // first row of the sliver
+
+                        // Columns of the block that are non-zero in the sliver
+                        const std::size_t start = lower || i <= pc ? 0 : i - pc;
+                        const std::size_t end = lower ? std::min(kc, i + mr - pc) : kc;
+
+                        for (std::size_t jr = 0; jr < nc; jr += NR) {
+                            const std::size_t nr = std::min(NR, nc - jr);
+                            microKernel(end - start, &packedA[ir * kc + start * MR], &packedB[jr * kc + start * NR],
+                                        &C(i, jc + jr), C.rowStride, C.colStride, mr, nr, alpha);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // Rows [pc, pc + kc[ and columns [jc, jc + nc[ of B, sliver by sliver,
+    // padded with zeros to a multiple of NR columns
+    void packB(MatrixView<Real const> B, std::size_t pc, std::size_t kc, std::size_t jc, std::size_t nc)
+    {
+        Real* out = packedB.data();
+        for (std::size_t jr = 0; jr < nc; jr += NR) {
+            const std::size_t nr = std::min(NR, nc - jr);
+            for (std::size_t p = 0; p < kc; ++p) {
+                for (std::size_t c = 0; c < NR; ++c) {
+                    *out++ = c < nr ? B(pc + p, jc + jr + c) : Real(0);
+                }
+            }
+        }
+    }
+
+    // Rows [ic, ic + mc[ and columns [pc, pc + kc[ of A, sliver by sliver,
+    // with zeros outside the triangle and below the last row
+    void packA(Layout const& layout, bool lower, Real const* A, std::size_t ic, std::size_t mc, std::size_t pc, std::size_t kc)
+    {
+        Real* out = packedA.data();
+        for (std::size_t ir = 0; ir < mc; ir += MR) {
+            for (std::size_t p = 0; p < kc; ++p) {
+                const std::size_t k = pc + p;
+                for (std::size_t r = 0; r < MR; ++r) {
+                    const std::size_t i = ic + ir + r;
+                    const bool inside = ir + r < mc && (lower ? k <= i : i <= k);
+                    *out++ = inside ? A[layout(i, k)] : Real(0);
+                }
+            }
+        }
+    }
+
+    // C[0..mr[[0..nr[ += alpha a b over `depth` columns of the sliver a and rows of the sliver b
+    static void microKernel(std::size_t depth, Real const* a, Real const* b, Real* C,
+                            std::size_t rowStride, std::size_t colStride,
+                            std::size_t mr, std::size_t nr, Real alpha)
+    {
+        Real acc[MR][NR] = {};
+        for (std::size_t p = 0; p < depth; ++p, a += MR, b += NR) {
+            for (std::size_t r = 0; r < MR; ++r) {
+                for (std::size_t c = 0; c < NR; ++c) {
+                    acc[r][c] += a[r] * b[c];
+                }
+            }
+        }
+
+        for (std::size_t r = 0; r < mr; ++r) {
+            for (std::size_t c = 0; c < nr; ++c) {
+                C[r * rowStride + c * colStride] += alpha * acc[r][c];
+            }
+        }
+    }
+
+    std::vector<Real> packedA, packedB;
+};
+
+template <typename Real, typename Layout>
+constexpr std::size_t BlockedTrmm<Real, Layout>::MR;
+template <typename Real, typename Layout>
+constexpr std::size_t BlockedTrmm<Real, Layout>::NR;
+template <typename Real, typename Layout>
+constexpr std::size_t BlockedTrmm<Real, Layout>::MC;
+template <typename Real, typename Layout>
+constexpr std::size_t BlockedTrmm<Real, Layout>::KC;
+template <typename Real, typename Layout>
+constexpr std::size_t BlockedTrmm<Real, Layout>::NC;
+
+/*!
+ * @brief Split the columns [0, N[ into one band per thread and run task(band) on each
+ *
+ * The bands hold whole groups of `granularity` columns.
+ */
+template <typename Task>
+void forEachColumnBand(std::size_t N, std::size_t granularity, std::size_t threads, Task const& task)
+{
+    const std::size_t groups = (N + granularity - 1) / granularity;
+    const std::size_t bands = std::max(std::size_t(1), std::min(threads, groups));
+
+    parallelFor(bands, threads, [&](std::size_t band) {
+        const Range columns = {
+            std::min(N, band * groups / bands * granularity),
+            std::min(N, (band + 1) * groups / bands * granularity)
+        };
+        task(columns);
+    });
+}
+
+/*!
+ * @brief C = A B computed by several threads
+ *
+ * Row i of C costs i + 1 operations per column, so equal bands of rows
+ * would leave most of the work to the thread holding the last rows. Every
+ * column of C costs the same, however : each thread computes an equal band
+ * of columns (in whole slivers of the micro-kernel) with its own buffers.
+ */
+template <typename Layout, typename Real>
+void parallelTrmm(std::size_t N, Real const* A, Real const* B, Real* C, std::size_t threads)
+{
+    forEachColumnBand(N, BlockedTrmm<Real, Layout>::NR, threads, [&](Range columns) {
+        BlockedTrmm<Real, Layout>().multiply(N, A, B, C, columns.first, columns.last);
+    });
+}
+
+#endif // TRIANGULARMATRIX_KERNELS_HPP
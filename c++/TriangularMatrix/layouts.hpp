@@ -0,0 +1,97 @@
+#ifndef TRIANGULARMATRIX_LAYOUTS_HPP
+#define TRIANGULARMATRIX_LAYOUTS_HPP
+
+#include <cstddef>
+#include <string>
+
+//
+// Storage layouts of an NxN lower triangular matrix
+//
+// A layout is built from N and maps an entry (i, k) with k <= i to its index
+// in the storage, in constant time :
+//
+//  - size() is the number of values to store;
+//  - operator()(i, k) is the index of entry (i, k);
+//  - name() identifies the layout in the CSV output.
+//
+// Entries above the diagonal are not accessed through a layout; those that
+// are stored anyway (full and blocked layouts) must be zero.
+//
+
+// Rows one after the other : row i starts at i (i + 1) / 2
+struct RowPacked
+{
+    explicit RowPacked(std::size_t N) : N(N) { /* - */ }
+
+    std::size_t size() const { return N * (N + 1) / 2; }
+
+    std::size_t operator()(std::size_t i, std::size_t k) const { return i * (i + 1) / 2 + k; }
+
+    static std::string name() { return "row"; }
+
+    std::size_t N;
+};
+
+// Columns one after the other : column k holds rows k to N - 1 and starts at k N - k (k - 1) / 2
+struct ColumnPacked
+{
+    explicit ColumnPacked(std::size_t N) : N(N) { /* - */ }
+
+    std::size_t size() const { return N * (N + 1) / 2; }
+
+    std::size_t operator()(std::size_t i, std::size_t k) const { return k * (2 * N - k - 1) / 2 + i; }
+
+    static std::string name() { return "column"; }
+
+    std::size_t N;
+};
+
+// Square tiles of T x T values on and below the diagonal, stored row of tiles
+// after row of tiles; each tile is a row-major block and the matrix is padded
+// with zeros to a multiple of T
+struct BlockedPacked
+{
+    static constexpr std::size_t T = 64;
+
+    explicit BlockedPacked(std::size_t N) : N(N), tiles((N + T - 1) / T) { /* - */ }
+
+    std::size_t size() const { return tiles * (tiles + 1) / 2 * T * T; }
+
+    std::size_t operator()(std::size_t i, std::size_t k) const {
+        const std::size_t I = i / T, K = k / T;
+        return (I * (I + 1) / 2 + K) * T * T + (i % T) * T + k % T;
+    }
+
+    static std::string name() { return "blocked"; }
+
+    std::size_t N;
+    std::size_t tiles;
+};
+
+// NxN row-major matrix whose upper half is zero
+struct Full
+{
+    explicit Full(std::size_t N) : N(N) { /* - */ }
+
+    std::size_t size() const { return N * N; }
+
+    std::size_t operator()(std::size_t i, std::size_t k) const { return i * N + k; }
+
+    static std::string name() { return "full"; }
+
+    std::size_t N;
+};
+
+// Entries of a matrix stored with arbitrary strides, such as a row-major
+// matrix with leading dimension ld (ld, 1) or its transpose (1, ld); used to
+// read the triangle of a caller-supplied matrix
+struct Strided
+{
+    Strided(std::size_t rowStride, std::size_t colStride) : rowStride(rowStride), colStride(colStride) { /* - */ }
+
+    std::size_t operator()(std::size_t i, std::size_t k) const { return i * rowStride + k * colStride; }
+
+    std::size_t rowStride, colStride;
+};
+
+#endif // TRIANGULARMATRIX_LAYOUTS_HPP
@@ -2,13 +2,17 @@
 #include <vector>
 #include <sstream>
 #include <numeric>
+#include <iostream>
+#include <cmath>
+#include <SFML/System.hpp>
 
-typedef double Real;
-typedef std::vector<Real> Matrix;
-
-std::ostream& operator<<(std::ostream& out, Matrix const& m);
+template <typename Real>
+std::ostream& operator<<(std::ostream& out, std::vector<Real> const& m);
 
 #include "stats.hpp"
+#include "precision.hpp"
+#include "kernels.hpp"
+#include "blas3.hpp"
 
 //
 // Compute the NxN matrix multiplication of a lower triangular matrix A with a square matrix B
@@ -17,7 +21,8 @@ std::ostream& operator<<(std::ostream& out, Matrix const& m);
 // Disable output of matrix data
 // #define OUTPUT_MATRIX_DATA
 
-std::ostream& operator<<(std::ostream& out, Matrix const& m)
+template <typename Real>
+std::ostream& operator<<(std::ostream& out, std::vector<Real> const& m)
 {
 #ifdef OUTPUT_MATRIX_DATA
     const std::size_t NN = m.size();
@@ -30,57 +35,308 @@ std::ostream& operator<<(std::ostream& out, Matrix const& m)
 #endif
 }
 
+// Product with the throughput of its kernel
+template <typename Real>
+struct Product
+{
+    std::vector<Real> const& C; // the caller's output buffer, not copied
+    double gflops;
+    double efficiency; // parallel efficiency : speedup over one thread divided by the thread count
+    sf::Int64 setup;   // time spent allocating and initialising A, B and C, in µs
+};
+
+template <typename Real>
+std::ostream& operator<<(std::ostream& out, Product<Real> const& product)
+{
+    return out << product.C << "," << product.gflops << "," << product.efficiency << "," << product.setup;
+}
+
+// A, lower triangular, stored with Layout; entry (i, k) is value(i, k)
+template <typename Layout, typename Real, typename Value>
+std::vector<Real> makeTriangular(std::size_t N, Value const& value)
+{
+    const Layout layout(N);
+    std::vector<Real> A(layout.size(), Real(0));
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t k = 0; k <= i; ++k) {
+            A[layout(i, k)] = value(i, k);
+        }
+    }
+    return A;
+}
+
+// A rows x columns row-major matrix; entry (i, j) is value(i, j)
+template <typename Real, typename Value>
+std::vector<Real> makeMatrix(std::size_t rows, std::size_t columns, Value const& value)
+{
+    std::vector<Real> B(rows * columns);
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < columns; ++j) {
+            B[i * columns + j] = value(i, j);
+        }
+    }
+    return B;
+}
+
+template <typename Real, typename Layout = RowPacked>
 struct TriMatrixMul
 {
-    // N is the dimension of the matrixes
-    TriMatrixMul(std::size_t N)
-    : N(N)
+    typedef std::vector<Real> Matrix;
+
+    // A, stored with Layout, and B are the NxN operands and C the NxN output
+    // buffer, all supplied by the caller and reused by every run; they must
+    // outlive the action. setup is the time the caller spent preparing them,
+    // in µs, only reported. baseline is the GFLOP/s of the kernel with one
+    // thread, if known, used to compute the parallel efficiency
+    TriMatrixMul(Matrix const& A, Matrix const& B, Matrix& C, std::size_t N, Kernel kernel,
+                 std::size_t threads = 1, double baseline = 0, sf::Int64 setup = 0)
+    : A(A)
+    , B(B)
+    , C(C)
+    , N(N)
+    , kernel(kernel)
+    , threads(threads)
+    , baseline(baseline)
+    , setup(setup)
     { /* */ }
 
-    // Perform the computation
-    Matrix operator()() const {
-        // Create A, a lower triangular matrix
-        Matrix A(N * (N + 1) / 2, 0.0);
-        std::iota(A.begin(), A.end(), 0.0);
-
-        // Create B, a square matrix
-        Matrix B(N * N, 0.0);
-        std::iota(B.begin(), B.end(), 0.0);
-
-        // Create result matrix C
-        Matrix C(N * N, 0.0);
-
-        // Compute the result
-        for (std::size_t i = 0, offset = 0; i < N; offset += ++i) {
-            for (std::size_t j = 0; j < N; ++j) {
-                Real sum = 0;
-                for (std::size_t k = 0; k <= i; ++k) {
-                    sum += A[offset + k] * B[k * N + j];
-                }
-                C[i * N + j] = sum;
-            }
-        }
+    // Perform the computation; nothing is allocated
+    Product<Real> operator()() const {
+        sf::Clock clk;
+        multiply();
+        const double seconds = clk.restart().asSeconds();
+
+        const double gflops = seconds > 0 ? trmmFlops(N) / seconds * 1e-9 : 0;
+        return { C, gflops, baseline > 0 ? gflops / (threads * baseline) : 1, setup };
+    }
 
-        return C;
+    void multiply() const {
+        switch (kernel) {
+            case Kernel::BLOCKED:
+                parallelTrmm<Layout>(N, A.data(), B.data(), C.data(), threads);
+                break;
+
+            default:
+                naiveTrmm<Layout>(N, A.data(), B.data(), C.data());
+                break;
+        }
     }
 
     std::string csvdescription() const {
         std::stringstream ss;
-        ss << N;
+        ss << Precision<Real>::name() << "," << Layout::name() << "," << kernelName(kernel) << "," << threads << "," << N;
         return ss.str();
     }
 
+    Matrix const& A;
+    Matrix const& B;
+    Matrix& C;
     std::size_t N;
+    Kernel kernel;
+    std::size_t threads;
+    double baseline;
+    sf::Int64 setup;
 };
 
+// Small integers, so that the products are exact in every precision
+template <typename Real>
+Real smallValue(std::size_t i, std::size_t k)
+{
+    return Real(int((i * 3 + k) % 7) - 3);
+}
+
+// Compare the blocked kernel on a layout with the naive one on packed rows;
+// returns the number of differing entries
+template <typename Real, typename Layout>
+std::size_t verify(std::size_t N, std::size_t threads)
+{
+    typedef typename TriMatrixMul<Real>::Matrix Matrix;
+
+    const Matrix packed = makeTriangular<RowPacked, Real>(N, smallValue<Real>);
+    const Matrix A = makeTriangular<Layout, Real>(N, smallValue<Real>);
+    const Matrix B = makeMatrix<Real>(N, N, [N](std::size_t i, std::size_t j) {
+        return Real(int((i * N + j) % 5) - 2);
+    });
+
+    Matrix expected(N * N), actual(N * N);
+    TriMatrixMul<Real>(packed, B, expected, N, Kernel::NAIVE).multiply();
+    TriMatrixMul<Real, Layout>(A, B, actual, N, Kernel::BLOCKED, threads).multiply();
+
+    std::size_t errors = 0;
+    for (std::size_t i = 0; i < N * N; ++i) {
+        if (expected[i] != actual[i]) {
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+// Compare trmm with its naive reference, and check that trsm brings the
+// product back to its operand, for one combination of options on M x N
+// operands; T has ones and minus ones on its diagonal, so that the solve
+// is exact too. Returns the number of differing entries
+template <typename Real>
+std::size_t verifyBlas3(Side side, Uplo uplo, Transpose trans, std::size_t M, std::size_t N, std::size_t threads)
+{
+    typedef std::vector<Real> Matrix;
+
+    // Leading dimensions larger than the matrices, to exercise them too
+    const std::size_t n = side == Side::LEFT ? M : N;
+    const std::size_t ldt = n + 3, ldb = N + 1, ldc = N + 2;
+
+    Matrix T = makeMatrix<Real>(n, ldt, smallValue<Real>);
+    for (std::size_t i = 0; i < n; ++i) {
+        T[i * ldt + i] = i % 2 == 0 ? Real(1) : Real(-1);
+    }
+    const Matrix B = makeMatrix<Real>(M, ldb, [](std::size_t i, std::size_t j) {
+        return Real(int((i + 2 * j) % 5) - 2);
+    });
+
+    Matrix expected(M * ldc), actual(M * ldc);
+    naiveTrmm(side, uplo, trans, M, N, Real(2), T.data(), ldt, B.data(), ldb, expected.data(), ldc);
+    trmm(side, uplo, trans, M, N, Real(2), T.data(), ldt, B.data(), ldb, actual.data(), ldc, threads);
+
+    std::size_t errors = 0;
+    for (std::size_t i = 0; i < M; ++i) {
+        for (std::size_t j = 0; j < N; ++j) {
+            if (expected[i * ldc + j] != actual[i * ldc + j]) {
+                ++errors;
+            }
+        }
+    }
+
+    // op(T) X = 1/2 (2 op(T) B) gives X = B back
+    trsm(side, uplo, trans, M, N, Real(0.5), T.data(), ldt, actual.data(), ldc, threads);
+    for (std::size_t i = 0; i < M; ++i) {
+        for (std::size_t j = 0; j < N; ++j) {
+            if (actual[i * ldc + j] != B[i * ldb + j]) {
+                ++errors;
+            }
+        }
+    }
+    return errors;
+}
+
+// A for the benchmark, a lower triangular matrix whose rows are 0, 1, 2, ... once packed
+template <typename Layout, typename Real>
+std::vector<Real> makeBenchmarkA(std::size_t N)
+{
+    return makeTriangular<Layout, Real>(N, [](std::size_t i, std::size_t k) {
+        return Real(i * (i + 1) / 2 + k);
+    });
+}
+
+// Blocked kernel on a layout with every thread count; setup is the time
+// already spent preparing B and C, in µs
+template <typename Real, typename Layout>
+void benchmarkLayout(std::size_t N, std::vector<Real> const& B, std::vector<Real>& C, sf::Int64 setup,
+                     std::vector<std::size_t> const& threadCounts)
+{
+    typedef TriMatrixMul<Real, Layout> Action;
+
+    sf::Clock clk;
+    const typename Action::Matrix A = makeBenchmarkA<Layout, Real>(N);
+    setup += clk.restart().asMicroseconds();
+
+    // The first run, which also warms up the caches, gives the baseline
+    const double baseline = Action(A, B, C, N, Kernel::BLOCKED)().gflops;
+    for (auto const& threads: threadCounts) {
+        stats<Action, Product<Real> >(Action(A, B, C, N, Kernel::BLOCKED, threads, baseline, setup), 4);
+    }
+}
+
+// Naive kernel on packed rows up to N = 2^12, blocked kernel on every layout
+//
+// The operands and the output buffer are allocated and initialised once,
+// outside of the timed region, and shared by every run : the time column
+// only covers the product. B is filled with 0, 1, 2, ...
+template <typename Real>
+void benchmark(std::size_t N, std::vector<std::size_t> const& threadCounts)
+{
+    sf::Clock clk;
+    std::vector<Real> B(N * N);
+    std::iota(B.begin(), B.end(), Real(0));
+    std::vector<Real> C(N * N, Real(0)); // touch every page before the first run
+    const sf::Int64 setup = clk.restart().asMicroseconds();
+
+    if (N <= 4096) {
+        const std::vector<Real> A = makeBenchmarkA<RowPacked, Real>(N);
+        const sf::Int64 naiveSetup = setup + clk.restart().asMicroseconds();
+        stats<TriMatrixMul<Real>, Product<Real> >(TriMatrixMul<Real>(A, B, C, N, Kernel::NAIVE, 1, 0, naiveSetup), 4);
+    }
+
+    benchmarkLayout<Real, RowPacked>(N, B, C, setup, threadCounts);
+    benchmarkLayout<Real, ColumnPacked>(N, B, C, setup, threadCounts);
+    benchmarkLayout<Real, BlockedPacked>(N, B, C, setup, threadCounts);
+    benchmarkLayout<Real, Full>(N, B, C, setup, threadCounts);
+}
+
+template <typename Layout>
+void verifyLayout(std::size_t N, std::size_t threads)
+{
+    std::cout << "N = " << N << ", " << Layout::name() << ", " << threads << " threads : "
+              << verify<float, Layout>(N, threads) << " "
+              << verify<double, Layout>(N, threads) << " "
+              << verify<long double, Layout>(N, threads)
+              << " errors" << std::endl;
+}
+
+void verifyBlas3(std::size_t M, std::size_t N, std::size_t threads)
+{
+    for (Side side: { Side::LEFT, Side::RIGHT }) {
+        for (Uplo uplo: { Uplo::LOWER, Uplo::UPPER }) {
+            for (Transpose trans: { Transpose::NO, Transpose::YES }) {
+                std::cout << "M = " << M << ", N = " << N << ", " << sideName(side) << ", " << uploName(uplo) << ", "
+                          << transposeName(trans) << ", " << threads << " threads : "
+                          << verifyBlas3<float>(side, uplo, trans, M, N, threads) << " "
+                          << verifyBlas3<double>(side, uplo, trans, M, N, threads) << " "
+                          << verifyBlas3<long double>(side, uplo, trans, M, N, threads)
+                          << " errors" << std::endl;
+            }
+        }
+    }
+}
 
 int main(int argc, const char * argv[])
 {
-    // Make stats from N = 2 to N = 2^12
-    for (std::size_t N = 2; N <= 4096; N *= 2) {
-        stats<TriMatrixMul, Matrix>(TriMatrixMul(N), 4);
+    #ifdef VERIFY_PRODUCT
+    // Sizes that are not multiples of the blocks
+    for (std::size_t N: { 1, 3, 17, 130, 257, 1100 }) {
+        for (std::size_t threads: { 1, 3, 8 }) {
+            verifyLayout<RowPacked>(N, threads);
+            verifyLayout<ColumnPacked>(N, threads);
+            verifyLayout<BlockedPacked>(N, threads);
+            verifyLayout<Full>(N, threads);
+        }
+    }
+
+    // Triangular products and solves on rectangular operands
+    for (std::size_t M: { 1, 17, 300 }) {
+        for (std::size_t N: { 1, 5, 130, 600 }) {
+            for (std::size_t threads: { 1, 3 }) {
+                verifyBlas3(M, N, threads);
+            }
+        }
     }
 
     return 0;
-}
+    #endif
+
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t t = 1; t < hardwareThreads(); t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(hardwareThreads());
 
+    // Make stats from N = 2 to N = 2^14, or 2^12 in long double;
+    // the output is precision,layout,kernel,threads,N,C,GFLOP/s,efficiency,setup,time
+    for (std::size_t N = 2; N <= 16384; N *= 2) {
+        benchmark<float>(N, threadCounts);
+        benchmark<double>(N, threadCounts);
+        if (N <= 4096) {
+            benchmark<long double>(N, threadCounts);
+        }
+    }
+
+    return 0;
+}
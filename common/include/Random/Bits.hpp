@@ -0,0 +1,31 @@
+
+#ifndef RANDOM_BITS_HPP
+#define RANDOM_BITS_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+/*!
+ * @brief Number in [0, 1) made from the high bits of a random word
+ *
+ * Only as many bits as the mantissa of Real holds are used so that the
+ * result is exact and never rounds up to 1.
+ */
+template <typename Real>
+Real unitFromBits(std::uint64_t bits)
+{
+    constexpr int digits = std::numeric_limits<Real>::digits < 64 ? std::numeric_limits<Real>::digits : 64;
+    return static_cast<Real>(bits >> (64 - digits)) * std::ldexp(Real(1), -digits);
+}
+
+/*!
+ * @brief Number in [0, 1) made from two random 32-bit words
+ */
+template <typename Real>
+Real unitFromBits(std::uint32_t high, std::uint32_t low)
+{
+    return unitFromBits<Real>((std::uint64_t(high) << 32) | low);
+}
+
+#endif // RANDOM_BITS_HPP
@@ -0,0 +1,239 @@
+
+#ifndef RANDOM_CONTEXT_HPP
+#define RANDOM_CONTEXT_HPP
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include "Xoshiro.hpp"
+
+/*!
+ * @brief Source of random numbers used by uniform, normal and exponential
+ *
+ * A context owns its generators, so two threads drawing from two contexts
+ * never share any state. Contexts are either passed explicitly to the
+ * functions or bound to the calling thread :
+ *
+ *  - every thread has a default context, seeded from the process seed and
+ *    the order in which the threads first draw a number;
+ *  - a Scope binds another context to the current thread for its lifetime.
+ *
+ * Besides single numbers, a context fills whole arrays at once with uniform,
+ * normal or exponential numbers of fixed parameters; the single draws are
+ * taken from buffers of standard variates filled that way.
+ *
+ * For reproducible runs, seed a context explicitly and give each task its
+ * own stream with split(task), which only depends on the seed and the task
+ * index, not on the thread that ends up running it.
+ */
+class RandomContext
+{
+public:
+    // Generator for integers and the distributions of <random>
+    typedef Xoshiro256Plus Engine;
+
+    explicit RandomContext(std::uint64_t seed)
+    {
+        this->seed(seed);
+    }
+
+    void seed(std::uint64_t value)
+    {
+        seed_ = value;
+        engine_.seed(value);
+        batch_.seed(~value);
+        floats.clear();
+        doubles.clear();
+        longDoubles.clear();
+    }
+
+    std::uint64_t seed() const { return seed_; }
+
+    Engine& engine() { return engine_; }
+
+    UniformBatch& batch() { return batch_; }
+
+    // Independent context for stream `stream`, derived from the seed only
+    RandomContext split(std::uint64_t stream) const
+    {
+        std::uint64_t state = seed_ ^ (stream * 0xD1B54A32D192ED03ull);
+        splitMix64(state);
+        return RandomContext(splitMix64(state));
+    }
+
+    // Fill out with count numbers drawn uniformly in [min, max)
+    template <typename Real>
+    void fillUniform(Real* out, std::size_t count, Real min = 0, Real max = 1)
+    {
+        batch_.fill(out, count);
+        if (min != 0 || max != 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = min + (max - min) * out[i];
+            }
+        }
+    }
+
+    // Fill out with count numbers drawn from normal(mu, sigma2)
+    //
+    // Box–Muller transform : both variates of each pair of uniform numbers are used.
+    template <typename Real>
+    void fillNormal(Real* out, std::size_t count, Real mu = 0, Real sigma2 = 1)
+    {
+        const Real sigma = std::sqrt(sigma2);
+        const Real twoPi = Real(6.283185307179586476925286766559);
+        const std::size_t pairs = count / 2;
+
+        batch_.fill(out, 2 * pairs);
+        for (std::size_t i = 0; i < 2 * pairs; i += 2) {
+            const Real radius = sigma * std::sqrt(-2 * std::log(1 - out[i])); // 1 - u is in (0, 1]
+            const Real angle = twoPi * out[i + 1];
+            out[i] = mu + radius * std::cos(angle);
+            out[i + 1] = mu + radius * std::sin(angle);
+        }
+
+        if (count % 2 != 0) {
+            Real last[2];
+            fillNormal(last, 2, mu, sigma2);
+            out[count - 1] = last[0];
+        }
+    }
+
+    // Fill out with count numbers drawn from exp(lambda)
+    template <typename Real>
+    void fillExponential(Real* out, std::size_t count, Real lambda = 1)
+    {
+        batch_.fill(out, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = -std::log(1 - out[i]) / lambda;
+        }
+    }
+
+    // Next number in [0, 1), taken from a buffer refilled by the batch generator
+    template <typename Real>
+    Real nextUnit()
+    {
+        Buffer<Real>& buffer = buffersFor(static_cast<Real*>(nullptr)).units;
+        if (buffer.empty()) {
+            fillUniform(buffer.values.data(), buffer.values.size());
+            buffer.next = 0;
+        }
+        return buffer.values[buffer.next++];
+    }
+
+    // Next number from normal(0, 1), taken from a buffer
+    template <typename Real>
+    Real nextNormal()
+    {
+        Buffer<Real>& buffer = buffersFor(static_cast<Real*>(nullptr)).normals;
+        if (buffer.empty()) {
+            fillNormal(buffer.values.data(), buffer.values.size());
+            buffer.next = 0;
+        }
+        return buffer.values[buffer.next++];
+    }
+
+    // Next number from exp(1), taken from a buffer
+    template <typename Real>
+    Real nextExponential()
+    {
+        Buffer<Real>& buffer = buffersFor(static_cast<Real*>(nullptr)).exponentials;
+        if (buffer.empty()) {
+            fillExponential(buffer.values.data(), buffer.values.size());
+            buffer.next = 0;
+        }
+        return buffer.values[buffer.next++];
+    }
+
+    // Context used by the calling thread
+    static RandomContext& current()
+    {
+        RandomContext* bound = binding();
+        return bound != nullptr ? *bound : threadDefault();
+    }
+
+    // Seed of the default contexts; random unless set before the first draw
+    static void setProcessSeed(std::uint64_t value)
+    {
+        processSeed() = value;
+    }
+
+    // Bind a context to the calling thread until the end of the scope
+    class Scope
+    {
+    public:
+        explicit Scope(RandomContext& context)
+        : previous(binding())
+        {
+            binding() = &context;
+        }
+
+        ~Scope()
+        {
+            binding() = previous;
+        }
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+    private:
+        RandomContext* previous;
+    };
+
+private:
+    template <typename Real>
+    struct Buffer
+    {
+        std::array<Real, 256> values;
+        std::size_t next;
+
+        bool empty() const { return next == values.size(); }
+    };
+
+    // Standard variates of one type, drawn in advance
+    template <typename Real>
+    struct Buffers
+    {
+        Buffer<Real> units, normals, exponentials;
+
+        void clear()
+        {
+            units.next = units.values.size();
+            normals.next = normals.values.size();
+            exponentials.next = exponentials.values.size();
+        }
+    };
+
+    Buffers<float>& buffersFor(float*) { return floats; }
+    Buffers<double>& buffersFor(double*) { return doubles; }
+    Buffers<long double>& buffersFor(long double*) { return longDoubles; }
+
+    static RandomContext*& binding()
+    {
+        static thread_local RandomContext* bound = nullptr;
+        return bound;
+    }
+
+    static std::atomic<std::uint64_t>& processSeed()
+    {
+        static std::atomic<std::uint64_t> value((std::uint64_t(std::random_device()()) << 32) ^ std::random_device()());
+        return value;
+    }
+
+    static RandomContext& threadDefault()
+    {
+        static std::atomic<std::uint64_t> threads(0);
+        static thread_local RandomContext context(RandomContext(processSeed().load()).split(threads++));
+        return context;
+    }
+
+    std::uint64_t seed_;
+    Engine engine_;
+    UniformBatch batch_;
+    Buffers<float> floats;
+    Buffers<double> doubles;
+    Buffers<long double> longDoubles;
+};
+
+#endif // RANDOM_CONTEXT_HPP
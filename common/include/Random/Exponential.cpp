@@ -6,20 +6,17 @@
 
 #include "Exponential.hpp"
 
-double exponential(double lambda)
+double exponential(RandomContext& context, double lambda)
 {
-    static std::default_random_engine algo;
-
-    static bool initialise = true;
-    if (initialise) {
-        initialise = false;
-        std::random_device rd;
-        algo.seed(rd());
-    }
-
-    typedef std::exponential_distribution<> distribution_type;
+    return context.nextExponential<double>() / lambda;
+}
 
-    distribution_type dist(lambda);
+double exponential(double lambda)
+{
+    return exponential(RandomContext::current(), lambda);
+}
 
-    return dist(algo);
+void exponential(RandomContext& context, double* out, std::size_t count, double lambda)
+{
+    context.fillExponential(out, count, lambda);
 }
@@ -9,14 +9,33 @@
 
 #include <cmath>
 #include <random>
+#include "Context.hpp"
 
 /*!
  * @brief Randomly generate a number on a exponential distribution
  *
+ * @param context source of randomness
  * @param lambda rate
  * @return a random number fitting the exp(lambda) distribution
  */
+double exponential(RandomContext& context, double lambda);
+
+/*!
+ * @brief Same as above, with the context of the calling thread
+ */
 double exponential(double lambda);
 
+/*!
+ * @brief Fill an array with numbers of the same distribution
+ *
+ * Much faster than drawing the numbers one by one with other parameters.
+ *
+ * @param context source of randomness
+ * @param out array of at least count numbers
+ * @param count number of numbers to draw
+ * @param lambda rate
+ */
+void exponential(RandomContext& context, double* out, std::size_t count, double lambda);
+
 #endif // INFOSV_RANDOM_EXPONENTIAL_HPP
 
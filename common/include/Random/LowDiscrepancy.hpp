@@ -0,0 +1,192 @@
+
+#ifndef RANDOM_LOW_DISCREPANCY_HPP
+#define RANDOM_LOW_DISCREPANCY_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+/*!
+ * @brief Sobol sequence in up to 10 dimensions
+ *
+ * The coordinates are 32-bit binary fractions : coordinate d of a point is
+ * out[d] / 2^32. The direction numbers are those of Joe & Kuo
+ * (new-joe-kuo-6.21201); the first 2^m points of every dimension hit each
+ * interval [k / 2^m, (k + 1) / 2^m) exactly once.
+ *
+ * Points are generated in Gray code order, one XOR per coordinate; any
+ * point can also be computed directly, which lets several threads work on
+ * different parts of the sequence.
+ *
+ * A random digital shift (XOR of every coordinate with a random word) keeps
+ * those properties and gives independent randomised copies of the sequence
+ * from which an error can be estimated.
+ */
+class Sobol
+{
+public:
+    static constexpr std::size_t maxDimension = 10;
+    static constexpr std::size_t bits = 32;
+
+    explicit Sobol(std::size_t dimension, std::uint64_t first = 0)
+    : directions(dimension)
+    , x(dimension, 0)
+    , shift(dimension, 0)
+    , index(first)
+    {
+        if (dimension == 0 || dimension > maxDimension) {
+            throw std::domain_error("Unsupported Sobol dimension");
+        }
+
+        for (std::size_t d = 0; d < dimension; ++d) {
+            initialiseDirections(d, directions[d]);
+        }
+        seek(first);
+    }
+
+    std::size_t dimension() const { return x.size(); }
+
+    // XOR every coordinate d with shift[d] from now on
+    void setShift(std::vector<std::uint32_t> const& words)
+    {
+        shift = words;
+        shift.resize(dimension(), 0);
+    }
+
+    // Continue the sequence from point `first`
+    void seek(std::uint64_t first)
+    {
+        index = first;
+        const std::uint64_t gray = first ^ (first >> 1);
+        for (std::size_t d = 0; d < dimension(); ++d) {
+            x[d] = 0;
+            for (std::size_t b = 0; b < bits; ++b) {
+                if (gray & (std::uint64_t(1) << b)) {
+                    x[d] ^= directions[d][b];
+                }
+            }
+        }
+    }
+
+    // Write the current point to out and move to the next one
+    void next(std::uint32_t* out)
+    {
+        for (std::size_t d = 0; d < dimension(); ++d) {
+            out[d] = x[d] ^ shift[d];
+        }
+
+        // Gray code : the next point differs by the direction of the lowest zero bit of the index
+        std::size_t c = 0;
+        for (std::uint64_t i = index; i & 1; i >>= 1) {
+            ++c;
+        }
+        for (std::size_t d = 0; d < dimension(); ++d) {
+            x[d] ^= directions[d][c];
+        }
+        ++index;
+    }
+
+private:
+    typedef std::array<std::uint32_t, bits> Directions;
+
+    static void initialiseDirections(std::size_t d, Directions& v)
+    {
+        // Degree s, coefficients a and initial numbers m of the primitive
+        // polynomials of dimensions 2 to 10; the first dimension is the van
+        // der Corput sequence
+        struct Polynomial { std::size_t s; std::uint32_t a; std::uint32_t m[5]; };
+        static const Polynomial polynomials[maxDimension - 1] = {
+            { 1, 0, { 1 } },
+            { 2, 1, { 1, 3 } },
+            { 3, 1, { 1, 3, 1 } },
+            { 3, 2, { 1, 1, 1 } },
+            { 4, 1, { 1, 1, 3, 3 } },
+            { 4, 4, { 1, 3, 5, 13 } },
+            { 5, 2, { 1, 1, 5, 5, 17 } },
+            { 5, 4, { 1, 1, 5, 5, 5 } },
+            { 5, 7, { 1, 1, 7, 11, 19 } }
+        };
+
+        if (d == 0) {
+            for (std::size_t b = 0; b < bits; ++b) {
+                v[b] = std::uint32_t(1) << (bits - 1 - b);
+            }
+            return;
+        }
+
+        const Polynomial& p = polynomials[d - 1];
+        for (std::size_t b = 0; b < p.s && b < bits; ++b) {
+            v[b] = p.m[b] << (bits - 1 - b);
+        }
+        for (std::size_t b = p.s; b < bits; ++b) {
+            v[b] = v[b - p.s] ^ (v[b - p.s] >> p.s);
+            for (std::size_t k = 1; k < p.s; ++k) {
+                if ((p.a >> (p.s - 1 - k)) & 1) {
+                    v[b] ^= v[b - k];
+                }
+            }
+        }
+    }
+
+    std::vector<Directions> directions;
+    std::vector<std::uint32_t> x, shift;
+    std::uint64_t index;
+};
+
+/*!
+ * @brief Radical inverse of i in the given base : its digits mirrored after the point
+ */
+template <typename Real>
+Real radicalInverse(std::uint64_t i, unsigned int base)
+{
+    Real result = 0;
+    Real scale = Real(1) / base;
+    for (; i > 0; i /= base, scale /= base) {
+        result += (i % base) * scale;
+    }
+    return result;
+}
+
+/*!
+ * @brief Halton sequence in up to 10 dimensions
+ *
+ * Coordinate d of point i is the radical inverse of i in the d-th prime base.
+ * It has no limit on the number of points but its higher dimensions are
+ * strongly correlated for small point counts; Sobol should be preferred.
+ */
+template <typename Real>
+class Halton
+{
+public:
+    static constexpr std::size_t maxDimension = 10;
+
+    explicit Halton(std::size_t dimension, std::uint64_t first = 0)
+    : dimension_(dimension)
+    , index(first)
+    {
+        if (dimension == 0 || dimension > maxDimension) {
+            throw std::domain_error("Unsupported Halton dimension");
+        }
+    }
+
+    std::size_t dimension() const { return dimension_; }
+
+    // Write the current point to out and move to the next one
+    void next(Real* out)
+    {
+        static const unsigned int primes[maxDimension] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29 };
+
+        for (std::size_t d = 0; d < dimension_; ++d) {
+            out[d] = radicalInverse<Real>(index, primes[d]);
+        }
+        ++index;
+    }
+
+private:
+    std::size_t dimension_;
+    std::uint64_t index;
+};
+
+#endif // RANDOM_LOW_DISCREPANCY_HPP
@@ -6,20 +6,17 @@
 
 #include "Normal.hpp"
 
-double normal(double mu, double sigma2)
+double normal(RandomContext& context, double mu, double sigma2)
 {
-    static std::default_random_engine algo;
-
-    static bool initialise = true;
-    if (initialise) {
-        initialise = false;
-        std::random_device rd;
-        algo.seed(rd());
-    }
-
-    typedef std::normal_distribution<> distribution_type;
+    return mu + std::sqrt(sigma2) * context.nextNormal<double>();
+}
 
-    distribution_type dist(mu, std::sqrt(sigma2));
+double normal(double mu, double sigma2)
+{
+    return normal(RandomContext::current(), mu, sigma2);
+}
 
-    return dist(algo);
+void normal(RandomContext& context, double* out, std::size_t count, double mu, double sigma2)
+{
+    context.fillNormal(out, count, mu, sigma2);
 }
@@ -9,15 +9,35 @@
 
 #include <cmath>
 #include <random>
+#include "Context.hpp"
 
 /*!
  * @brief Randomly generate a number on a normal distribution
  *
+ * @param context source of randomness
  * @param mu mean
  * @param sigma2 variance
  * @return a random number fitting the normal(mu, sigma2) distribution
  */
+double normal(RandomContext& context, double mu, double sigma2);
+
+/*!
+ * @brief Same as above, with the context of the calling thread
+ */
 double normal(double mu, double sigma2);
 
+/*!
+ * @brief Fill an array with numbers of the same distribution
+ *
+ * Much faster than drawing the numbers one by one with other parameters.
+ *
+ * @param context source of randomness
+ * @param out array of at least count numbers
+ * @param count number of numbers to draw
+ * @param mu mean
+ * @param sigma2 variance
+ */
+void normal(RandomContext& context, double* out, std::size_t count, double mu, double sigma2);
+
 #endif // INFOSV_RANDOM_NORMAL_HPP
 
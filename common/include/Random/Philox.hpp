@@ -0,0 +1,53 @@
+
+#ifndef RANDOM_PHILOX_HPP
+#define RANDOM_PHILOX_HPP
+
+#include <array>
+#include <cstdint>
+#include "Bits.hpp"
+
+/*!
+ * @brief Philox4x32-10 counter-based random number generator
+ *
+ * Each (counter, key) pair is mapped to four independent 32-bit words by ten
+ * rounds of multiplications and key injections (Salmon et al., "Parallel
+ * random numbers: as easy as 1, 2, 3", SC 2011). There is no state to carry
+ * from one draw to the next: draw i of stream k is block({i, ...}, k), so
+ * any thread can compute any part of a stream without generating the rest.
+ */
+struct Philox4x32
+{
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+    // Key derived from a 64-bit seed
+    static Key key(std::uint64_t seed)
+    {
+        return {{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) }};
+    }
+
+    // Counter whose two low words hold a 64-bit index
+    static Counter counter(std::uint64_t index, std::uint64_t stream = 0)
+    {
+        return {{ static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32),
+                  static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) }};
+    }
+
+    // The four words for a counter and a key
+    static Counter block(Counter ctr, Key key)
+    {
+        for (std::size_t round = 0; round < 10; ++round) {
+            const std::uint64_t p0 = std::uint64_t(0xD2511F53) * ctr[0];
+            const std::uint64_t p1 = std::uint64_t(0xCD9E8D57) * ctr[2];
+
+            ctr = {{ static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                     static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<std::uint32_t>(p0) }};
+
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return ctr;
+    }
+};
+
+#endif // RANDOM_PHILOX_HPP
@@ -9,37 +9,65 @@
 
 #include <type_traits>
 #include <random>
+#include "Context.hpp"
+
+namespace detail {
+
+    // Integers : usual distribution on the engine of the context
+    template <typename T>
+    T uniform(RandomContext& context, T min, T max, std::true_type /* is integral */)
+    {
+        std::uniform_int_distribution<T> dist(min, max);
+
+        return dist(context.engine());
+    }
+
+    // Floating-point numbers : taken from the buffer of the context
+    template <typename T>
+    T uniform(RandomContext& context, T min, T max, std::false_type /* is integral */)
+    {
+        return min + (max - min) * context.nextUnit<T>();
+    }
+}
 
 /*!
  * @brief Randomly generate a number on a uniform distribution
  *
+ * Integers are drawn in [min, max] and floating-point numbers in [min, max).
+ *
+ * @param context source of randomness
  * @param min lower bound
  * @param max upper bound
  * @return a random number fitting the uniform distribution
  */
 template <typename T>
-T uniform(T min, T max)
+T uniform(RandomContext& context, T min, T max)
 {
-    static std::default_random_engine algo;
-    
-    static bool initialise = true;
-    if (initialise) {
-        initialise = false;
-        std::random_device rd;
-        algo.seed(rd());
-    }
-
-    typedef typename std::is_integral<T> condition;
-    typedef typename std::uniform_int_distribution<T> integer_dist;
-    typedef typename std::uniform_real_distribution<T> real_dist;
-
-    typedef typename std::conditional<condition::value,
-                                      integer_dist,
-                                      real_dist>::type distribution_type;
+    return detail::uniform(context, min, max, typename std::is_integral<T>::type());
+}
 
-    distribution_type dist(min, max);
+/*!
+ * @brief Same as above, with the context of the calling thread
+ */
+template <typename T>
+T uniform(T min, T max)
+{
+    return uniform(RandomContext::current(), min, max);
+}
 
-    return dist(algo);
+/*!
+ * @brief Fill an array with floating-point numbers on a uniform distribution
+ *
+ * @param context source of randomness
+ * @param out array of at least count numbers
+ * @param count number of numbers to draw
+ * @param min lower bound
+ * @param max upper bound
+ */
+template <typename T>
+void uniform(RandomContext& context, T* out, std::size_t count, T min, T max)
+{
+    context.fillUniform(out, count, min, max);
 }
 
 #endif // INFOSV_RANDOM_UNIFORM_HPP
@@ -0,0 +1,324 @@
+
+#ifndef RANDOM_XOSHIRO_HPP
+#define RANDOM_XOSHIRO_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include "Bits.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define RANDOM_X86
+    #include <immintrin.h>
+#endif
+
+/*!
+ * @brief splitmix64, used to turn a seed into well mixed states
+ */
+inline std::uint64_t splitMix64(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/*!
+ * @brief xoshiro256+ generator (Blackman & Vigna)
+ *
+ * Meets the requirements of a uniform random bit generator so it can be used
+ * with the distributions of <random>. The lowest bits of its output are
+ * weaker than the others; the conversions to floating-point numbers only use
+ * the high bits.
+ */
+class Xoshiro256Plus
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit Xoshiro256Plus(std::uint64_t value = 0)
+    {
+        seed(value);
+    }
+
+    void seed(std::uint64_t value)
+    {
+        for (auto& word: s) {
+            word = splitMix64(value);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = s[0] + s[3];
+        const std::uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = (s[3] << 45) | (s[3] >> 19);
+
+        return result;
+    }
+
+    /*!
+     * @brief Advance the state by 2^128 draws
+     *
+     * Calling jump() repeatedly gives non-overlapping streams.
+     */
+    void jump()
+    {
+        static const std::uint64_t polynomial[] = {
+            0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull
+        };
+
+        std::uint64_t t[4] = { 0, 0, 0, 0 };
+        for (auto const& word: polynomial) {
+            for (std::size_t b = 0; b < 64; ++b) {
+                if (word & (std::uint64_t(1) << b)) {
+                    for (std::size_t i = 0; i < 4; ++i) {
+                        t[i] ^= s[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+        std::copy(t, t + 4, s);
+    }
+
+    std::uint64_t s[4];
+};
+
+/*!
+ * @brief Fill arrays with uniform numbers in [0, 1), several at a time
+ *
+ * Four xoshiro256+ generators, each one jumped 2^128 draws ahead of the
+ * previous one, run side by side in the lanes of an AVX2 register when the
+ * CPU supports it. The numbers are made directly from the bit pattern : the
+ * high bits of a draw become the mantissa of a number in [1, 2) from which 1
+ * is subtracted, which gives 52 random bits for a double and 23 for a float.
+ * Each draw gives one double or two floats (one from each 32-bit half).
+ *
+ * The scalar path gives exactly the same numbers as the vector one.
+ * Other types (long double) use the scalar path and unitFromBits.
+ */
+class UniformBatch
+{
+public:
+    static constexpr std::size_t lanes = 4;
+
+    explicit UniformBatch(std::uint64_t seed = 0, bool vectorized = vectorSupported())
+    : vectorized(vectorized)
+    {
+        this->seed(seed);
+    }
+
+    // Can the vector path run on this CPU ?
+    static bool vectorSupported()
+    {
+        #ifdef RANDOM_X86
+        return __builtin_cpu_supports("avx2");
+        #else
+        return false;
+        #endif
+    }
+
+    bool isVectorized() const { return vectorized; }
+
+    void seed(std::uint64_t value)
+    {
+        Xoshiro256Plus generator(value);
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                s[i][lane] = generator.s[i];
+            }
+            generator.jump();
+        }
+    }
+
+    void fill(double* out, std::size_t count)
+    {
+        fillGroups(out, count, lanes, [this](double* group, std::size_t groups) {
+            #ifdef RANDOM_X86
+            if (vectorized) {
+                fillDoublesAVX2(group, groups);
+                return;
+            }
+            #endif
+            fillDoubles(group, groups);
+        });
+    }
+
+    void fill(float* out, std::size_t count)
+    {
+        fillGroups(out, count, 2 * lanes, [this](float* group, std::size_t groups) {
+            #ifdef RANDOM_X86
+            if (vectorized) {
+                fillFloatsAVX2(group, groups);
+                return;
+            }
+            #endif
+            fillFloats(group, groups);
+        });
+    }
+
+    template <typename Real>
+    void fill(Real* out, std::size_t count)
+    {
+        fillGroups(out, count, lanes, [this](Real* group, std::size_t groups) {
+            std::uint64_t r[lanes];
+            for (std::size_t g = 0; g < groups; ++g, group += lanes) {
+                step(r);
+                for (std::size_t lane = 0; lane < lanes; ++lane) {
+                    group[lane] = unitFromBits<Real>(r[lane]);
+                }
+            }
+        });
+    }
+
+private:
+    // Write the whole groups straight to out and the last partial one through a buffer
+    template <typename Real, typename Kernel>
+    static void fillGroups(Real* out, std::size_t count, std::size_t groupSize, Kernel const& kernel)
+    {
+        const std::size_t groups = count / groupSize;
+        kernel(out, groups);
+
+        const std::size_t rest = count - groups * groupSize;
+        if (rest > 0) {
+            Real last[2 * lanes];
+            kernel(last, 1);
+            std::copy(last, last + rest, out + groups * groupSize);
+        }
+    }
+
+    // One draw of every lane
+    void step(std::uint64_t* r)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            r[lane] = s[0][lane] + s[3][lane];
+            const std::uint64_t t = s[1][lane] << 17;
+
+            s[2][lane] ^= s[0][lane];
+            s[3][lane] ^= s[1][lane];
+            s[1][lane] ^= s[2][lane];
+            s[0][lane] ^= s[3][lane];
+            s[2][lane] ^= t;
+            s[3][lane] = (s[3][lane] << 45) | (s[3][lane] >> 19);
+        }
+    }
+
+    static double toDouble(std::uint64_t bits)
+    {
+        const std::uint64_t pattern = (bits >> 12) | 0x3FF0000000000000ull;
+        double d;
+        std::memcpy(&d, &pattern, sizeof(d));
+        return d - 1.0;
+    }
+
+    static float toFloat(std::uint32_t bits)
+    {
+        const std::uint32_t pattern = (bits >> 9) | 0x3F800000u;
+        float f;
+        std::memcpy(&f, &pattern, sizeof(f));
+        return f - 1.0f;
+    }
+
+    void fillDoubles(double* out, std::size_t groups)
+    {
+        std::uint64_t r[lanes];
+        for (std::size_t g = 0; g < groups; ++g, out += lanes) {
+            step(r);
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+                out[lane] = toDouble(r[lane]);
+            }
+        }
+    }
+
+    // Same order as the vector path : low half then high half of each lane
+    void fillFloats(float* out, std::size_t groups)
+    {
+        std::uint64_t r[lanes];
+        for (std::size_t g = 0; g < groups; ++g, out += 2 * lanes) {
+            step(r);
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+                out[2 * lane] = toFloat(static_cast<std::uint32_t>(r[lane]));
+                out[2 * lane + 1] = toFloat(static_cast<std::uint32_t>(r[lane] >> 32));
+            }
+        }
+    }
+
+    #ifdef RANDOM_X86
+    __attribute__((target("avx2")))
+    static __m256i nextAVX2(__m256i& s0, __m256i& s1, __m256i& s2, __m256i& s3)
+    {
+        const __m256i result = _mm256_add_epi64(s0, s3);
+        const __m256i t = _mm256_slli_epi64(s1, 17);
+
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+
+        return result;
+    }
+
+    __attribute__((target("avx2")))
+    void fillDoublesAVX2(double* out, std::size_t groups)
+    {
+        __m256i s0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[0]));
+        __m256i s1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[1]));
+        __m256i s2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[2]));
+        __m256i s3 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[3]));
+
+        const __m256i exponent = _mm256_set1_epi64x(0x3FF0000000000000ll);
+        const __m256d one = _mm256_set1_pd(1.0);
+
+        for (std::size_t g = 0; g < groups; ++g, out += lanes) {
+            const __m256i bits = _mm256_or_si256(_mm256_srli_epi64(nextAVX2(s0, s1, s2, s3), 12), exponent);
+            _mm256_storeu_pd(out, _mm256_sub_pd(_mm256_castsi256_pd(bits), one));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[0]), s0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[1]), s1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[2]), s2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[3]), s3);
+    }
+
+    __attribute__((target("avx2")))
+    void fillFloatsAVX2(float* out, std::size_t groups)
+    {
+        __m256i s0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[0]));
+        __m256i s1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[1]));
+        __m256i s2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[2]));
+        __m256i s3 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s[3]));
+
+        const __m256i exponent = _mm256_set1_epi32(0x3F800000);
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        for (std::size_t g = 0; g < groups; ++g, out += 2 * lanes) {
+            const __m256i bits = _mm256_or_si256(_mm256_srli_epi32(nextAVX2(s0, s1, s2, s3), 9), exponent);
+            _mm256_storeu_ps(out, _mm256_sub_ps(_mm256_castsi256_ps(bits), one));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[0]), s0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[1]), s1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[2]), s2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s[3]), s3);
+    }
+    #endif
+
+    bool vectorized;
+    std::uint64_t s[4][lanes]; // word i of the state of every lane
+};
+
+#endif // RANDOM_XOSHIRO_HPP
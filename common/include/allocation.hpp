@@ -0,0 +1,48 @@
+
+#ifndef ALLOCATION_HPP
+#define ALLOCATION_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Count the bytes requested from the global operator new
+ *
+ * This header replaces the global operator new and delete, so it must be
+ * included by exactly one translation unit of a program; since every
+ * benchmark is a single .cpp file, include it from there.
+ *
+ * The array and nothrow forms forward to operator new(std::size_t) by
+ * default, so they are counted too.
+ */
+
+inline std::atomic<std::size_t>& allocationCounter()
+{
+    static std::atomic<std::size_t> bytes(0);
+    return bytes;
+}
+
+// Total number of bytes allocated so far
+inline std::size_t allocatedBytes()
+{
+    return allocationCounter().load();
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCounter() += size;
+
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+#endif // ALLOCATION_HPP
@@ -0,0 +1,147 @@
+
+#ifndef INTEGRATION_HPP
+#define INTEGRATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "parallel.hpp"
+#include "Random/Philox.hpp"
+
+/*!
+ * Box [lower[0], upper[0]] x ... x [lower[D-1], upper[D-1]]
+ */
+template <std::size_t Dimension, typename Real>
+struct Box
+{
+    typedef std::array<Real, Dimension> Point;
+
+    Point lower, upper;
+
+    // [0, 1]^Dimension
+    static Box unit()
+    {
+        Box box;
+        box.lower.fill(Real(0));
+        box.upper.fill(Real(1));
+        return box;
+    }
+
+    // [lower, upper]^Dimension
+    static Box cube(Real lower, Real upper)
+    {
+        Box box;
+        box.lower.fill(lower);
+        box.upper.fill(upper);
+        return box;
+    }
+
+    Real volume() const
+    {
+        Real v = 1;
+        for (std::size_t d = 0; d < Dimension; ++d) {
+            v *= upper[d] - lower[d];
+        }
+        return v;
+    }
+};
+
+/*!
+ * Result of a Monte Carlo integration
+ */
+template <typename Real>
+struct Integral
+{
+    Real value;
+    Real standardError; // of the value, from the sample variance
+    std::size_t pointCount;
+};
+
+// Points handed out to a thread at once
+constexpr std::size_t integrationChunkSize = 1 << 16;
+
+/*!
+ * Point `index` of the random stream `key`, uniformly distributed in a box
+ *
+ * Coordinates 2k and 2k + 1 come from the Philox4x32 block for counter
+ * (index, k), so a point only depends on its index and the seed.
+ */
+template <std::size_t Dimension, typename Real>
+std::array<Real, Dimension> randomPoint(std::uint64_t index, Philox4x32::Key const& key, Box<Dimension, Real> const& domain)
+{
+    std::array<Real, Dimension> x;
+    for (std::size_t k = 0; 2 * k < Dimension; ++k) {
+        const Philox4x32::Counter r = Philox4x32::block(Philox4x32::counter(index, k), key);
+        x[2 * k] = unitFromBits<Real>(r[0], r[1]);
+        if (2 * k + 1 < Dimension) {
+            x[2 * k + 1] = unitFromBits<Real>(r[2], r[3]);
+        }
+    }
+
+    for (std::size_t d = 0; d < Dimension; ++d) {
+        x[d] = domain.lower[d] + (domain.upper[d] - domain.lower[d]) * x[d];
+    }
+    return x;
+}
+
+/*!
+ * Integrate f over a box with pointCount random points using several threads
+ *
+ * The points are split into fixed chunks handed out to the threads; each
+ * chunk sums f and f² and the sums are added in chunk order at the end, so
+ * the result only depends on the seed, not on the number of threads. Sums
+ * are kept in double at least.
+ *
+ * The dimension is a template parameter so that a point is a std::array that
+ * the compiler can keep in registers.
+ *
+ * @tparam Integrand function called as f(std::array<Real, Dimension> const&) -> Real
+ *
+ * @param f function to integrate
+ * @param domain box over which f is integrated
+ * @param pointCount number of random points
+ * @param seed key of the random stream
+ * @param threads number of threads to use
+ */
+template <std::size_t Dimension, typename Real, typename Integrand>
+Integral<Real> integrate(Integrand const& f, Box<Dimension, Real> const& domain,
+                         std::size_t pointCount, std::uint64_t seed, std::size_t threads = 1)
+{
+    typedef typename std::common_type<Real, double>::type Sum;
+
+    const Philox4x32::Key key = Philox4x32::key(seed);
+    const std::size_t chunkCount = (pointCount + integrationChunkSize - 1) / integrationChunkSize;
+    std::vector<Sum> sums(chunkCount, 0), squares(chunkCount, 0);
+
+    parallelFor(chunkCount, threads, [&](std::size_t chunk) {
+        const std::size_t first = chunk * integrationChunkSize;
+        const std::size_t last = std::min(first + integrationChunkSize, pointCount);
+
+        Sum sum = 0, square = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            const Sum y = f(randomPoint(i, key, domain));
+            sum += y;
+            square += y * y;
+        }
+        sums[chunk] = sum;
+        squares[chunk] = square;
+    });
+
+    Sum sum = 0, square = 0;
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        sum += sums[chunk];
+        square += squares[chunk];
+    }
+
+    const Sum n = static_cast<Sum>(pointCount);
+    const Sum mean = sum / n;
+    const Sum variance = pointCount > 1 ? std::max(Sum(0), (square - n * mean * mean) / (n - 1)) : Sum(0);
+    const Sum volume = domain.volume();
+
+    return { static_cast<Real>(volume * mean), static_cast<Real>(volume * std::sqrt(variance / n)), pointCount };
+}
+
+#endif // INTEGRATION_HPP
@@ -0,0 +1,177 @@
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * Number of threads the hardware can run concurrently, at least one
+ */
+inline std::size_t hardwareThreads()
+{
+    const std::size_t count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+/*!
+ * Apply a task to every index of [0, count[ using several threads
+ *
+ * The indexes are handed out dynamically through an atomic counter so that
+ * a thread that finishes a cheap task immediately picks up the next one;
+ * this keeps the load balanced when the cost of the tasks varies a lot.
+ *
+ * The calling thread takes part in the computation; with threads = 1 no
+ * other thread is created and the indexes are processed in order.
+ *
+ * @tparam Task function called as task(index)
+ *
+ * @param count number of tasks
+ * @param threads number of threads to use
+ * @param task function to apply
+ */
+template <typename Task>
+void parallelFor(std::size_t count, std::size_t threads, Task const& task)
+{
+    if (threads <= 1 || count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    const auto worker = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads && t < count; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread: pool) {
+        thread.join();
+    }
+}
+
+/*!
+ * Threads kept alive to run many parallel loops in a row
+ *
+ * parallelFor starts and joins its threads on every call, which dominates
+ * when the loops are short and numerous; a pool starts them once. run()
+ * hands out the indexes the same way as parallelFor, with the calling
+ * thread taking part, and returns when every task is done.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t threads)
+    {
+        for (std::size_t t = 1; t < threads; ++t) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto& thread: workers) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /// Number of threads, including the calling one
+    std::size_t size() const { return workers.size() + 1; }
+
+    /*!
+     * Apply a task to every index of [0, count[ using the threads of the pool
+     *
+     * @tparam Task function called as task(index)
+     */
+    template <typename Task>
+    void run(std::size_t count, Task const& task)
+    {
+        if (workers.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = [&task](std::size_t i) { task(i); };
+            this->count = count;
+            next = 0;
+            busy = workers.size();
+            ++round;
+        }
+        wake.notify_all();
+
+        process();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return busy == 0; });
+        current = nullptr;
+    }
+
+private:
+    void process()
+    {
+        for (std::size_t i = next++; i < count; i = next++) {
+            current(i);
+        }
+    }
+
+    void work()
+    {
+        std::size_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || round != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = round;
+            }
+
+            process();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+
+    // Current loop, set under the mutex before round is incremented
+    std::function<void(std::size_t)> current;
+    std::size_t count = 0;
+    std::atomic<std::size_t> next{0};
+    std::size_t busy = 0;  // workers that have not finished the round
+    std::size_t round = 0;
+    bool stopping = false;
+};
+
+#endif
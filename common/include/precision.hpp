@@ -0,0 +1,33 @@
+
+#ifndef PRECISION_HPP
+#define PRECISION_HPP
+
+#include <string>
+
+/*!
+ * Floating point type used by a benchmark
+ *
+ * name() is the name reported in the CSV outputs.
+ */
+template <typename Real>
+struct Precision;
+
+template <>
+struct Precision<float>
+{
+    static std::string name() { return "float"; }
+};
+
+template <>
+struct Precision<double>
+{
+    static std::string name() { return "double"; }
+};
+
+template <>
+struct Precision<long double>
+{
+    static std::string name() { return "long double"; }
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
 #include <thrust/sequence.h>
+#include <algorithm>
 #include "cuda_complex.hpp"
 #include "stats.hpp"
 
@@ -31,13 +32,18 @@ static const Color notInSetColor = false;
 
 typedef std::size_t Index;
 
+// Default amount of device memory used for the image
+static const std::size_t defaultMemoryBudget = 256 * 1024 * 1024;
+
 struct Mandelbrot : public thrust::unary_function<Index, Color>
 {
     Mandelbrot(std::size_t side, std::size_t maxIterations,
-               ComplexRange const& range)
+               ComplexRange const& range,
+               std::size_t memoryBudget = defaultMemoryBudget)
     : side(side)
     , maxIterations(maxIterations)
     , range(range)
+    , memoryBudget(memoryBudget)
     { /* - */ }
 
     // Perform the set computation
@@ -48,48 +54,26 @@ struct Mandelbrot : public thrust::unary_function<Index, Color>
         thrust::host_vector<Color> img(size);
 
         /*
-         * WARNING : limited memory
-         *
-         * If the computation is too intense (# iterations) it seems the device runs
-         * out of memory faster..
-         *
-         * Here a naive workaround is implemented : if the size of the set and the resolution
-         * is too high then the work is splitted.
-         *
-         * A better implementation would take account of the free memory on the GPU.
+         * The device memory is limited : the image is computed in chunks of
+         * at most memoryBudget bytes on the device, each chunk being copied
+         * back to the host before the next one is computed.
          */
+        const std::size_t step = std::max<std::size_t>(1, std::min(size, memoryBudget / sizeof(Color)));
 
-        // Those numbers are really magic....
-        if ((side >= 4000 && side < 10000 && maxIterations >= 4000) ||
-            (side >= 10000 && maxIterations >= 500)) {
-
-            const std::size_t step = 1000000;
-
-            // Create an array on the device
-            thrust::device_vector<Color> deviceImg(step);
+        // Create an array on the device
+        thrust::device_vector<Color> deviceImg(step);
 
-            for (std::size_t i = 0; i < size; i += step) {
-                // Then, transform the indexes into 'colors'
-                thrust::transform(thrust::counting_iterator<Index>(i),
-                                  thrust::counting_iterator<Index>(std::min(i + step, size)),
-                                  deviceImg.begin(),
-                                  *this); // apply op()(Index)
-
-                // Copy the data to the host memory
-                thrust::copy(deviceImg.begin(), deviceImg.end(), img.begin() + i);
-            }
-        } else {
-            // Create an array on the device
-            thrust::device_vector<Color> deviceImg(size);
+        for (std::size_t i = 0; i < size; i += step) {
+            const std::size_t end = std::min(i + step, size);
 
             // Then, transform the indexes into 'colors'
-            thrust::transform(thrust::counting_iterator<Index>(0),
-                              thrust::counting_iterator<Index>(size),
+            thrust::transform(thrust::counting_iterator<Index>(i),
+                              thrust::counting_iterator<Index>(end),
                               deviceImg.begin(),
                               *this); // apply op()(Index)
-            
+
             // Copy the data to the host memory
-            thrust::copy(deviceImg.begin(), deviceImg.end(), img.begin());
+            thrust::copy(deviceImg.begin(), deviceImg.begin() + (end - i), img.begin() + i);
         }
 
         #ifdef SAVE_IMAGE
@@ -146,6 +130,7 @@ struct Mandelbrot : public thrust::unary_function<Index, Color>
 
     std::size_t side, maxIterations;
     ComplexRange range;
+    std::size_t memoryBudget;
 };
 
 int main(int, char**)
@@ -44,8 +44,8 @@ struct TriMatrixMul
 
     struct Computer
     {
-        Computer(PointerOnDevice const& A, PointerOnDevice const& B, std::size_t N)
-        : A(B)
+        Computer(PointerOnDevice A, PointerOnDevice B, std::size_t N)
+        : A(A)
         , B(B)
         , N(N)
         { /*  */ }
@@ -57,9 +57,8 @@ struct TriMatrixMul
             const std::size_t i = ij % N;
             const std::size_t j = ij / N;
 
-            // Compute the offset for A
-            std::size_t offset = 0;
-            for (std::size_t x = 0; x <= i; offset += ++x);
+            // Compute the offset for A : row i of the packed matrix starts at i (i + 1) / 2
+            const std::size_t offset = i * (i + 1) / 2;
 
             // Compute the element
             Real sum = 0;
@@ -70,8 +69,8 @@ struct TriMatrixMul
             return sum;
         }
 
-        PointerOnDevice const& A;
-        PointerOnDevice const& B;
+        PointerOnDevice A;
+        PointerOnDevice B;
         std::size_t N;
     };
 